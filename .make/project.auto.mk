@@ -30,9 +30,12 @@ ifeq ($(TYPE),lib)
 else ifeq ($(TYPE),bin)
     TARGET:=$(BINARY_DIRECTORY)/$(NAME)
     MAIN_OBJ:=$(patsubst $(SOURCE_DIRECTORY)/%.c,$(OBJECT_DIRECTORY)/%.o,$(SOURCE_DIRECTORY)/$(MAIN_SRC))
-    OBJ_WITHOUT_MAIN=$(filter-out $(MAIN_OBJ),$(OBJ))
+    EXTRA_MAIN_OBJ:=$(foreach b,$(EXTRA_BINARIES),$(OBJECT_DIRECTORY)/$($(b)_MAIN_SRC:.c=.o))
+    EXTRA_TARGETS:=$(addprefix $(BINARY_DIRECTORY)/,$(EXTRA_BINARIES))
+    OBJ_WITHOUT_MAIN=$(filter-out $(MAIN_OBJ) $(EXTRA_MAIN_OBJ),$(OBJ))
     ifdef BIN_EXT
         TARGET:=$(TARGET).$(BIN_EXT)
+        EXTRA_TARGETS:=$(addsuffix .$(BIN_EXT),$(EXTRA_TARGETS))
     endif
 else
     $(error Invalid target type)
@@ -66,6 +69,18 @@ ifeq ($(TYPE),bin)
     TEST_OBJ:=$(OBJ) $(TEST_OBJ)
 endif
 
+BENCH_OBJECT_DIRECTORY:=$(BENCH_OUTPUT_DIRECTORY)/obj
+BENCH_BINARY_DIRECTORY:=$(BENCH_OUTPUT_DIRECTORY)/bin
+BENCH_SRC:=$(call rwildcard,$(BENCH_DIRECTORY),*.c)
+BENCH_OBJ:=$(patsubst $(BENCH_DIRECTORY)/%.c,$(BENCH_OBJECT_DIRECTORY)/%.o,$(BENCH_SRC))
+BENCH_BIN:=$(patsubst $(BENCH_OBJECT_DIRECTORY)/%.o,$(BENCH_BINARY_DIRECTORY)/%,$(BENCH_OBJ))
+# Sources under benchmark, compiled again with the benchmark flags
+ifeq ($(TYPE),bin)
+    BENCH_LIB_OBJ:=$(patsubst $(OBJECT_DIRECTORY)/%,$(BENCH_OBJECT_DIRECTORY)/%,$(OBJ_WITHOUT_MAIN))
+else
+    BENCH_LIB_OBJ:=$(patsubst $(OBJECT_DIRECTORY)/%,$(BENCH_OBJECT_DIRECTORY)/%,$(OBJ))
+endif
+
 # Automatically link the library to the test binary if the target is a library
 ifeq ($(TYPE),lib)
     ifeq ($(TEST_CPPFLAGS),)
@@ -81,12 +96,29 @@ $(OBJECT_DIRECTORY)/%.o: $(SOURCE_DIRECTORY)/%.c
 	@mkdir -p $(@D)
 	$(CC) $(CPPFLAGS) $(CFLAGS) -c -o $@ $<
 
-$(TARGET): $(OBJ)
+$(TARGET): $(filter-out $(EXTRA_MAIN_OBJ),$(OBJ))
 	@mkdir -p $(@D)
 	@echo "*** Building target '$(notdir $@)'..."
 	$(CC) $(CPPFLAGS) $(CFLAGS) $(LDFLAGS) -o $@ $^ $(LDLIBS)
 	@echo "*** Target '$(notdir $@)' built successfully."
 
+ifeq ($(TYPE),bin)
+# Rule of an additional binary, `$(1)` is the name of the binary
+define EXTRA_BINARY_RULE
+$(BINARY_DIRECTORY)/$(1)$(if $(BIN_EXT),.$(BIN_EXT)): $(OBJECT_DIRECTORY)/$($(1)_MAIN_SRC:.c=.o) $(filter $(OBJECT_DIRECTORY)/$($(1)_OBJ_DIRECTORY)/%,$(OBJ))
+	@mkdir -p $$(@D)
+	@echo "*** Building target '$$(notdir $$@)'..."
+	$$(CC) $$(CPPFLAGS) $$(CFLAGS) $$(LDFLAGS) -o $$@ $$^ $($(1)_LDLIBS)
+	@echo "*** Target '$$(notdir $$@)' built successfully."
+
+$(1): $(BINARY_DIRECTORY)/$(1)$(if $(BIN_EXT),.$(BIN_EXT))
+
+IMPLICIT_PHONY+=$(1)
+endef
+
+$(foreach b,$(EXTRA_BINARIES),$(eval $(call EXTRA_BINARY_RULE,$(b))))
+endif
+
 $(OBJECT_DIRECTORY)/%.o: $(TEST_DIRECTORY)/%.c
 	@mkdir -p $(@D)
 	$(CC) $(TEST_CPPFLAGS) $(TEST_CFLAGS) -c -o $@ $<
@@ -96,6 +128,19 @@ $(TEST_BINARY_DIRECTORY)/%: $(OBJECT_DIRECTORY)/%.o
 	@echo "*** Building test '$(notdir $<)'..."
 	$(CC) $(TEST_CPPFLAGS) $(TEST_CFLAGS) $(TEST_LDFLAGS) -o $@ $< $(OBJ_WITHOUT_MAIN) $(TEST_LDLIBS)
 
+$(BENCH_OBJECT_DIRECTORY)/%.o: $(SOURCE_DIRECTORY)/%.c
+	@mkdir -p $(@D)
+	$(CC) $(BENCH_CPPFLAGS) $(BENCH_CFLAGS) -c -o $@ $<
+
+$(BENCH_OBJECT_DIRECTORY)/%.o: $(BENCH_DIRECTORY)/%.c
+	@mkdir -p $(@D)
+	$(CC) $(BENCH_CPPFLAGS) $(BENCH_CFLAGS) -c -o $@ $<
+
+$(BENCH_BINARY_DIRECTORY)/%: $(BENCH_OBJECT_DIRECTORY)/%.o $(BENCH_LIB_OBJ)
+	@mkdir -p $(@D)
+	@echo "*** Building benchmark '$(notdir $<)'..."
+	$(CC) $(BENCH_CPPFLAGS) $(BENCH_CFLAGS) $(BENCH_LDFLAGS) -o $@ $^ $(BENCH_LDLIBS)
+
 ifeq ($(TYPE),bin)
 run: $(TARGET)
 	@echo "*** Executing '$(notdir $<)'..."
@@ -118,6 +163,24 @@ test: $(OBJ_WITHOUT_MAIN) $(patsubst $(TEST_BINARY_DIRECTORY)/%,test_%,$(TEST_BI
 
 IMPLICIT_PHONY+=test
 
+# Keep the benchmark objects, make would remove them as intermediate files
+.SECONDARY: $(BENCH_OBJ) $(BENCH_LIB_OBJ)
+
+# Build benchmark binaries
+benches: $(BENCH_BIN)
+
+IMPLICIT_PHONY+=benches
+
+# Run a benchmark, its JSON report is written next to the binaries
+bench_%: $(BENCH_BINARY_DIRECTORY)/%
+	@echo "*** Running benchmark '$(notdir $<)'..."
+	@$(abspath $<) $(abspath $(BENCH_OUTPUT_DIRECTORY))/$*.json
+	@echo "*** Report written to '$(BENCH_OUTPUT_DIRECTORY)/$*.json'."
+
+bench: $(patsubst $(BENCH_BINARY_DIRECTORY)/%,bench_%,$(BENCH_BIN))
+
+IMPLICIT_PHONY+=bench
+
 ifeq ($(ENABLE_COVERAGE),1)
 # Collate coverage report
 GCNO:=$(OBJ:.o=.gcno) $(TEST_OBJ:.o=.gcno)
@@ -154,19 +217,23 @@ IMPLICIT_PHONY+=docs
 
 info: project_info platform_info
 
-build: $(TARGET)
+build: $(TARGET) $(EXTRA_TARGETS)
 
 clean_target:
-	$(RM) $(OBJ) $(TARGET)
+	$(RM) $(OBJ) $(TARGET) $(EXTRA_TARGETS)
 
 clean_tests:
 	$(RM) $(TEST_OBJ) $(TEST_BIN)
 
+clean_benches:
+	$(RM) -r $(BENCH_OBJECT_DIRECTORY) $(BENCH_BINARY_DIRECTORY)
+	$(RM) $(BENCH_OUTPUT_DIRECTORY)/*.json
+
 clean_docs:
 	doxide clean
 
-CLEAN_TARGETS+=clean_target clean_tests clean_docs
+CLEAN_TARGETS+=clean_target clean_tests clean_benches clean_docs
 
 clean: $(CLEAN_TARGETS)
 
-IMPLICIT_PHONY+=info build clean clean_tests clean_docs
+IMPLICIT_PHONY+=info build clean clean_tests clean_benches clean_docs
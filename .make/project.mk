@@ -13,6 +13,20 @@ TYPE:=bin
 # Required when TYPE is `bin`, ignored when TYPE is `lib`.
 MAIN_SRC:=main.c
 
+# Additional binaries built next to the main target, only when TYPE is `bin`.
+# For each binary `<name>` listed here, define:
+# - `<name>_MAIN_SRC`: source file containing its main function, relative to
+#   the SOURCE_DIRECTORY. It is left out of the main target and the tests.
+# - `<name>_OBJ_DIRECTORY`: the binary links only the objects of this
+#   subdirectory of the SOURCE_DIRECTORY, besides its main source.
+# - `<name>_LDLIBS`: libraries to link, instead of LDLIBS.
+EXTRA_BINARIES:=r2048-sim
+
+# Headless batch simulator, links only the core game logic
+r2048-sim_MAIN_SRC:=sim.c
+r2048-sim_OBJ_DIRECTORY:=core
+r2048-sim_LDLIBS:=-lm -lpthread
+
 # Build profile, either `DEBUG` or `RELEASE`
 BUILD_PROFILE:=DEBUG
 
@@ -34,6 +48,9 @@ INCLUDE_DIRECTORY:=include
 # Directory containing test files
 TEST_DIRECTORY:=test
 
+# Directory containing benchmark files
+BENCH_DIRECTORY:=bench
+
 # Directory containing build files
 BUILD_DIRECTORY:=build
 
@@ -126,7 +143,31 @@ TEST_CPPFLAGS:=-I$(INCLUDE_DIRECTORY)
 TEST_LDFLAGS:=
 
 # Test libraries to link
-TEST_LDLIBS:=-lm
+TEST_LDLIBS:=-lm -lpthread
+
+# ----------------------- #
+# BENCHMARK CONFIGURATION #
+# ----------------------- #
+#
+# This section is used to define the compiler flags, preprocessor flags, linker
+#    flags, and libraries to link when building the benchmark binaries.
+# Benchmarks compile their own copy of the sources with those flags, so the
+#    timings do not depend on the build profile (sanitizers, coverage...).
+
+# Benchmark compiler flags
+BENCH_CFLAGS:=-std=c99 -O2 -D NDEBUG
+
+# Benchmark preprocessor flags
+BENCH_CPPFLAGS:=-I$(INCLUDE_DIRECTORY)
+
+# Benchmark linker flags
+BENCH_LDFLAGS:=
+
+# Benchmark libraries to link
+BENCH_LDLIBS:=-lm
+
+# Directory receiving one JSON report per benchmark binary
+BENCH_OUTPUT_DIRECTORY:=$(BUILD_DIRECTORY)/bench
 
 # ---------------------- #
 # COVERAGE CONFIGURATION #
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef R2048_BENCH_H
+#define R2048_BENCH_H
+
+// Needed for `clock_gettime`, include this header before any system header
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#else
+#define BENCH_HAS_CYCLES 0
+#endif
+
+/**
+ * Benchmark suite, prints a table on stdout and optionally a JSON report
+ */
+typedef struct Bench {
+  const char *suite;
+  FILE *json;
+  bool first;
+} Bench;
+
+/**
+ * Timestamps taken at the start of a measurement
+ */
+typedef struct BenchTimer {
+  struct timespec time;
+  uint64_t cycles;
+} BenchTimer;
+
+/**
+ * Keeps the compiler from removing the code under benchmark
+ */
+static volatile uint64_t benchSink;
+
+static inline uint64_t BenchCycles(void) {
+#if BENCH_HAS_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Start a suite
+ *
+ * @param[out] bench suite to start
+ * @param suite name of the suite
+ * @param argc argument count of `main`
+ * @param argv arguments of `main`, the first one is the path of the JSON
+ * report to write, if any
+ * @return false if the report could not be opened
+ */
+static inline bool BenchInit(Bench *bench, const char *suite, int argc,
+                             char **argv) {
+  bench->suite = suite;
+  bench->first = true;
+  bench->json = NULL;
+  if (argc > 1) {
+    bench->json = fopen(argv[1], "w");
+    if (!bench->json) {
+      perror(argv[1]);
+      return false;
+    }
+    fprintf(bench->json, "{\n  \"suite\": \"%s\",\n  \"results\": [", suite);
+  }
+  printf("%-40s %14s %14s %12s\n", suite, "ns/op", "ops/sec", "cycles/op");
+  return true;
+}
+
+static inline void BenchStart(BenchTimer *timer) {
+  clock_gettime(CLOCK_MONOTONIC, &timer->time);
+  timer->cycles = BenchCycles();
+}
+
+/**
+ * Time accumulated over several measurements
+ */
+typedef struct BenchTotal {
+  double ns;
+  uint64_t cycles;
+} BenchTotal;
+
+/**
+ * Add the time elapsed since a timer started to a total
+ *
+ * @param[in,out] total total to add to
+ * @param[in] timer timer started before the measured operations
+ */
+static inline void BenchAccumulate(BenchTotal *total, const BenchTimer *timer) {
+  uint64_t cycles = BenchCycles() - timer->cycles;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  total->ns += (now.tv_sec - timer->time.tv_sec) * 1e9 +
+               (now.tv_nsec - timer->time.tv_nsec);
+  total->cycles += cycles;
+}
+
+/**
+ * Report a measurement
+ *
+ * @param[in] bench suite to report to
+ * @param[in] total time taken by the measured operations
+ * @param name name of the benchmark
+ * @param ops number of operations measured
+ */
+static inline void BenchReport(Bench *bench, const BenchTotal *total,
+                               const char *name, uint64_t ops) {
+  double nsPerOp = total->ns / ops;
+  double opsPerSec = ops / (total->ns / 1e9);
+  double cyclesPerOp = (double)total->cycles / ops;
+
+  if (BENCH_HAS_CYCLES) {
+    printf("%-40s %14.2f %14.0f %12.1f\n", name, nsPerOp, opsPerSec,
+           cyclesPerOp);
+  } else {
+    printf("%-40s %14.2f %14.0f %12s\n", name, nsPerOp, opsPerSec, "-");
+  }
+  if (bench->json) {
+    fprintf(bench->json,
+            "%s\n    {\"name\": \"%s\", \"ops\": %llu, \"ns_per_op\": %.3f, "
+            "\"ops_per_sec\": %.1f, \"cycles_per_op\": ",
+            bench->first ? "" : ",", name, (unsigned long long)ops, nsPerOp,
+            opsPerSec);
+    if (BENCH_HAS_CYCLES) {
+      fprintf(bench->json, "%.2f}", cyclesPerOp);
+    } else {
+      fprintf(bench->json, "null}");
+    }
+  }
+  bench->first = false;
+}
+
+/**
+ * Stop a measurement and report it
+ *
+ * @param[in] bench suite to report to
+ * @param[in] timer timer started before the measured operations
+ * @param name name of the benchmark
+ * @param ops number of operations measured
+ */
+static inline void BenchStop(Bench *bench, const BenchTimer *timer,
+                             const char *name, uint64_t ops) {
+  BenchTotal total = {0, 0};
+  BenchAccumulate(&total, timer);
+  BenchReport(bench, &total, name, ops);
+}
+
+/**
+ * Finish the suite and close the JSON report
+ *
+ * @param[in] bench suite to finish
+ */
+static inline void BenchFinish(Bench *bench) {
+  if (bench->json) {
+    fprintf(bench->json, "\n  ]\n}\n");
+    fclose(bench->json);
+    bench->json = NULL;
+  }
+}
+
+#endif
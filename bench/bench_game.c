@@ -0,0 +1,218 @@
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/game.h"
+#include "core/grid.h"
+#include "random.h"
+
+#define CORPUS_BOARDS 4096
+// Cap on the cells of a corpus, large grids get fewer boards
+#define CORPUS_CELLS (1 << 22)
+// Roughly the number of cells visited by each benchmark
+#define CELLS_PER_BENCH (1 << 25)
+
+static const uint8_t SIZES[] = {4, 8, 64, 255};
+static const char *DIRECTION_NAMES[] = {"LEFT", "UP", "RIGHT", "DOWN"};
+
+/**
+ * Boards sampled from played games, `count` boards of `length` cells
+ */
+typedef struct Corpus {
+  uint8_t size;
+  uint16_t length;
+  uint32_t count;
+  uint64_t *cells;
+} Corpus;
+
+// Play games that mostly keep to a corner, like a human would, and record the
+// board before every move
+static void CorpusInit(Corpus *corpus, uint8_t size, random_engine_t *re) {
+  static const Direction ORDER[] = {DOWN, LEFT, RIGHT, UP};
+  corpus->size = size;
+  corpus->length = (uint16_t)size * size;
+  corpus->count = 0;
+  uint32_t boards = CORPUS_CELLS / corpus->length;
+  if (boards > CORPUS_BOARDS) {
+    boards = CORPUS_BOARDS;
+  }
+  corpus->cells = malloc((size_t)boards * corpus->length * sizeof(uint64_t));
+  uint16_t *diff = malloc(corpus->length * sizeof(uint16_t));
+  while (corpus->count < boards) {
+    Game game;
+    GameInitWithEngine(&game, size, re);
+    while (corpus->count < boards) {
+      memcpy(&corpus->cells[(size_t)corpus->count * corpus->length],
+             game->grid->cells, corpus->length * sizeof(uint64_t));
+      ++corpus->count;
+      bool moved = false;
+      if (bernoulli_distribution(re, 0.2)) {
+        moved = GameMove(game, uniform_int_distribution(re, 0, 3), diff);
+      }
+      for (int i = 0; i < 4 && !moved; ++i) {
+        moved = GameMove(game, ORDER[i], diff);
+      }
+      if (!moved) {
+        break;
+      }
+      GameAddRandomTile(game);
+    }
+    GameFree(&game);
+  }
+  free(diff);
+}
+
+static inline uint64_t *CorpusBoard(const Corpus *corpus, uint32_t index) {
+  return &corpus->cells[(size_t)index * corpus->length];
+}
+
+static void BenchCorpus(Bench *bench, const Corpus *corpus,
+                        random_engine_t *re) {
+  char name[64];
+  BenchTimer timer;
+  Game game;
+  GameInitWithEngine(&game, corpus->size, re);
+  Grid grid = game->grid;
+  uint64_t *cells = grid->cells;
+  uint16_t *diff = malloc(corpus->length * sizeof(uint16_t));
+  uint16_t *available = malloc(corpus->length * sizeof(uint16_t));
+  uint64_t bytes = corpus->length * sizeof(uint64_t);
+  uint32_t rounds =
+      CELLS_PER_BENCH / ((uint64_t)corpus->count * corpus->length);
+  if (rounds == 0) {
+    rounds = 1;
+  }
+  uint64_t ops = (uint64_t)rounds * corpus->count;
+
+  // Copying a board back into the grid and summing it up again, included in
+  // the other benchmarks
+  snprintf(name, sizeof(name), "GridRestore/%ux%u", corpus->size,
+           corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(cells, CorpusBoard(corpus, i), bytes);
+      GridSync(grid);
+      benchSink += cells[i % corpus->length];
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+
+  for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+    snprintf(name, sizeof(name), "GameMove/%s/%ux%u",
+             DIRECTION_NAMES[direction], corpus->size, corpus->size);
+    BenchStart(&timer);
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (uint32_t i = 0; i < corpus->count; ++i) {
+        memcpy(cells, CorpusBoard(corpus, i), bytes);
+        GridSync(grid);
+        benchSink += GameMove(game, direction, diff);
+      }
+    }
+    BenchStop(bench, &timer, name, ops);
+  }
+
+  for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+    snprintf(name, sizeof(name), "GameMove/NoDiff/%s/%ux%u",
+             DIRECTION_NAMES[direction], corpus->size, corpus->size);
+    BenchStart(&timer);
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (uint32_t i = 0; i < corpus->count; ++i) {
+        memcpy(cells, CorpusBoard(corpus, i), bytes);
+        GridSync(grid);
+        benchSink += GameMove(game, direction, NULL);
+      }
+    }
+    BenchStop(bench, &timer, name, ops);
+  }
+
+  snprintf(name, sizeof(name), "GameAddRandomTiles/2/%ux%u", corpus->size,
+           corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(cells, CorpusBoard(corpus, i), bytes);
+      GridSync(grid);
+      benchSink += GameAddRandomTiles(game, 2);
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+
+  // Same spawns drawn from the embedded engine of a seeded game
+  Game seeded;
+  GameInitWithSeed(&seeded, corpus->size, 2048);
+  snprintf(name, sizeof(name), "GameAddRandomTiles/Seeded/2/%ux%u",
+           corpus->size, corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(seeded->grid->cells, CorpusBoard(corpus, i), bytes);
+      GridSync(seeded->grid);
+      benchSink += GameAddRandomTiles(seeded, 2);
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+  GameFree(&seeded);
+
+  // The pairs are looked for once after a restore, the game over check of
+  // every frame then reads the summary
+  snprintf(name, sizeof(name), "GameTileMatchesAvailable/%ux%u", corpus->size,
+           corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(cells, CorpusBoard(corpus, i), bytes);
+      GridSync(grid);
+      benchSink += GameTileMatchesAvailable(game);
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+
+  snprintf(name, sizeof(name), "GameCanMove/%ux%u", corpus->size,
+           corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(cells, CorpusBoard(corpus, i), bytes);
+      GridSync(grid);
+      benchSink += GameCanMove(game);
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+
+  snprintf(name, sizeof(name), "GridGetAvailableCells/%ux%u", corpus->size,
+           corpus->size);
+  BenchStart(&timer);
+  for (uint32_t r = 0; r < rounds; ++r) {
+    for (uint32_t i = 0; i < corpus->count; ++i) {
+      memcpy(cells, CorpusBoard(corpus, i), bytes);
+      GridSync(grid);
+      benchSink += GridGetAvailableCells(grid, available, corpus->length);
+    }
+  }
+  BenchStop(bench, &timer, name, ops);
+
+  free(available);
+  free(diff);
+  GameFree(&game);
+}
+
+int main(int argc, char **argv) {
+  Bench bench;
+  if (!BenchInit(&bench, "game", argc, argv)) {
+    return 1;
+  }
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+  for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); ++i) {
+    Corpus corpus;
+    CorpusInit(&corpus, SIZES[i], re);
+    BenchCorpus(&bench, &corpus, re);
+    free(corpus.cells);
+  }
+  random_engine_dtor(re);
+  BenchFinish(&bench);
+  return 0;
+}
@@ -0,0 +1,121 @@
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/game.h"
+#include "core/game_batch.h"
+#include "core/grid.h"
+#include "random.h"
+
+#define BOARDS 4096
+// Rounds of one move and one spawn on every board
+#define ROUNDS 64
+
+static const uint8_t SIZES[] = {4, 8};
+
+// Play random rollouts on the batch, restarting lost boards
+static void BenchBatch(Bench *bench, uint8_t size, random_engine_t *re) {
+  char name[64];
+  BenchTimer timer;
+  GameBatch batch;
+  GameBatchInit(&batch, size, BOARDS, 2048);
+  Direction *directions = malloc(BOARDS * sizeof(Direction));
+  bool *moved = malloc(BOARDS * sizeof(bool));
+  bool *alive = malloc(BOARDS * sizeof(bool));
+  uint64_t ops = (uint64_t)ROUNDS * BOARDS;
+
+  snprintf(name, sizeof(name), "GameBatchMove/%ux%u", size, size);
+  BenchTotal elapsed[3] = {{0, 0}, {0, 0}, {0, 0}};
+  for (int round = 0; round < ROUNDS; ++round) {
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      directions[b] = bounded_int_distribution(re, 4);
+    }
+    BenchStart(&timer);
+    benchSink += GameBatchMove(batch, directions, moved);
+    BenchAccumulate(&elapsed[0], &timer);
+    BenchStart(&timer);
+    benchSink += GameBatchSpawn(batch, moved);
+    BenchAccumulate(&elapsed[1], &timer);
+    BenchStart(&timer);
+    benchSink += GameBatchAlive(batch, alive);
+    BenchAccumulate(&elapsed[2], &timer);
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      if (!alive[b]) {
+        GameBatchReset(batch, b);
+      }
+    }
+  }
+  BenchReport(bench, &elapsed[0], name, ops);
+  snprintf(name, sizeof(name), "GameBatchSpawn/%ux%u", size, size);
+  BenchReport(bench, &elapsed[1], name, ops);
+  snprintf(name, sizeof(name), "GameBatchAlive/%ux%u", size, size);
+  BenchReport(bench, &elapsed[2], name, ops);
+
+  // The same rollouts, one Game at a time
+  Game *games = malloc(BOARDS * sizeof(Game));
+  for (uint32_t b = 0; b < BOARDS; ++b) {
+    GameInitWithSeed(&games[b], size, b);
+  }
+  elapsed[0] = elapsed[1] = elapsed[2] = (BenchTotal){0, 0};
+  for (int round = 0; round < ROUNDS; ++round) {
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      directions[b] = bounded_int_distribution(re, 4);
+    }
+    BenchStart(&timer);
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      moved[b] = GameMove(games[b], directions[b], NULL);
+    }
+    BenchAccumulate(&elapsed[0], &timer);
+    BenchStart(&timer);
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      if (moved[b]) {
+        benchSink += GameAddRandomTile(games[b]);
+      }
+    }
+    BenchAccumulate(&elapsed[1], &timer);
+    BenchStart(&timer);
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      alive[b] = GridAnyCellAvailable(games[b]->grid) ||
+                 GameTileMatchesAvailable(games[b]);
+    }
+    BenchAccumulate(&elapsed[2], &timer);
+    for (uint32_t b = 0; b < BOARDS; ++b) {
+      if (!alive[b]) {
+        GameFree(&games[b]);
+        GameInitWithSeed(&games[b], size, b + round * BOARDS);
+      }
+    }
+  }
+  snprintf(name, sizeof(name), "GameMove/Loop/%ux%u", size, size);
+  BenchReport(bench, &elapsed[0], name, ops);
+  snprintf(name, sizeof(name), "GameAddRandomTile/Loop/%ux%u", size, size);
+  BenchReport(bench, &elapsed[1], name, ops);
+  snprintf(name, sizeof(name), "GameAlive/Loop/%ux%u", size, size);
+  BenchReport(bench, &elapsed[2], name, ops);
+
+  for (uint32_t b = 0; b < BOARDS; ++b) {
+    GameFree(&games[b]);
+  }
+  free(games);
+  free(alive);
+  free(moved);
+  free(directions);
+  GameBatchFree(&batch);
+}
+
+int main(int argc, char **argv) {
+  Bench bench;
+  if (!BenchInit(&bench, "game_batch", argc, argv)) {
+    return 1;
+  }
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+  for (size_t i = 0; i < sizeof(SIZES) / sizeof(SIZES[0]); ++i) {
+    BenchBatch(&bench, SIZES[i], re);
+  }
+  random_engine_dtor(re);
+  BenchFinish(&bench);
+  return 0;
+}
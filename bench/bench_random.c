@@ -0,0 +1,252 @@
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "random.h"
+#include "xoshiro256ss.h"
+#include "xoshiro256ss_lanes.h"
+
+#define OPS (1 << 24)
+// Distributions that loop or call libm run fewer times
+#define SLOW_OPS (1 << 21)
+
+#define FILL_BATCH 1024
+// Weights of the large discrete distribution
+#define ALIAS_WEIGHTS 1024
+
+static uint64_t batch[FILL_BATCH];
+static const double WEIGHTS[] = {1, 2, 4, 8, 16, 32, 64, 128};
+
+int main(int argc, char **argv) {
+  Bench bench;
+  BenchTimer timer;
+  if (!BenchInit(&bench, "random", argc, argv)) {
+    return 1;
+  }
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_next(re);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_next", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += random_engine_next(re);
+  }
+  BenchStop(&bench, &timer, "random_engine_next/xoshiro256ss", OPS);
+
+  xoshiro256ss_t rng;
+  xoshiro256ss_seed(&rng, 2048);
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_step(&rng);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_step", OPS);
+
+  // Numbers drawn by batches of FILL_BATCH, reported per number
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; i += FILL_BATCH) {
+    random_engine_fill(re, batch, FILL_BATCH);
+    benchSink += batch[FILL_BATCH - 1];
+  }
+  BenchStop(&bench, &timer, "random_engine_fill/xoshiro256ss/1024", OPS);
+
+  // Bulk numbers from the vector lanes, reported per number
+  static const xoshiro256ss_lanes_kernel_t *LANE_KERNELS[] = {
+      &Xoshiro256ssLanesScalar, &Xoshiro256ssLanesAvx2,
+      &Xoshiro256ssLanesAvx512};
+  xoshiro256ss_lanes_t lanes;
+  xoshiro256ss_lanes_seed(&lanes, 2048);
+  for (size_t k = 0; k < sizeof(LANE_KERNELS) / sizeof(LANE_KERNELS[0]); ++k) {
+    if (!LANE_KERNELS[k]->supported()) {
+      continue;
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "xoshiro256ss_lanes_fill/%s/1024",
+             LANE_KERNELS[k]->name);
+    BenchStart(&timer);
+    for (uint32_t i = 0; i < OPS; i += FILL_BATCH) {
+      LANE_KERNELS[k]->fill(&lanes, batch, FILL_BATCH / XOSHIRO256SS_LANES);
+      benchSink += batch[FILL_BATCH - 1];
+    }
+    BenchStop(&bench, &timer, name, OPS);
+  }
+
+  random_engine_t *lanesEngine = Xoshiro256ssLanesEngine.ctor();
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; i += FILL_BATCH) {
+    random_engine_fill(lanesEngine, batch, FILL_BATCH);
+    benchSink += batch[FILL_BATCH - 1];
+  }
+  BenchStop(&bench, &timer, "random_engine_fill/xoshiro256ss_lanes/1024", OPS);
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += random_engine_next(lanesEngine);
+  }
+  BenchStop(&bench, &timer, "random_engine_next/xoshiro256ss_lanes", OPS);
+  random_engine_dtor(lanesEngine);
+
+  random_engine_t *device = RandomDeviceEngine.ctor();
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += random_engine_next(device);
+  }
+  BenchStop(&bench, &timer, "random_engine_next/device", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; i += FILL_BATCH) {
+    random_engine_fill(device, batch, FILL_BATCH);
+    benchSink += batch[FILL_BATCH - 1];
+  }
+  BenchStop(&bench, &timer, "random_engine_fill/device/1024", SLOW_OPS);
+  random_engine_dtor(device);
+
+  device = RandomDeviceBufferedEngine.ctor();
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += random_engine_next(device);
+  }
+  BenchStop(&bench, &timer, "random_engine_next/device_buffered", SLOW_OPS);
+  random_engine_dtor(device);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += uniform_int_distribution(re, 0, 15);
+  }
+  BenchStop(&bench, &timer, "uniform_int_distribution/16", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += bounded_int_distribution(re, 16);
+  }
+  BenchStop(&bench, &timer, "bounded_int_distribution/16", OPS);
+
+  // Varying ranges, like the available cells of a board
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += uniform_int_distribution(re, 0, i % 15);
+  }
+  BenchStop(&bench, &timer, "uniform_int_distribution/1..15", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += bounded_int_distribution(re, 1 + i % 15);
+  }
+  BenchStop(&bench, &timer, "bounded_int_distribution/1..15", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += uniform_real_distribution(re, 0.0, 1.0) < 0.5;
+  }
+  BenchStop(&bench, &timer, "uniform_real_distribution", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += bernoulli_distribution(re, 0.9);
+  }
+  BenchStop(&bench, &timer, "bernoulli_distribution/0.9", OPS);
+
+  uint64_t threshold = bernoulli_threshold(0.9);
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += bernoulli_threshold_distribution(re, threshold);
+  }
+  BenchStop(&bench, &timer, "bernoulli_threshold_distribution/0.9", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_uniform_int(&rng, 0, 15);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_uniform_int/16", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_bernoulli(&rng, 0.9);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_bernoulli/0.9", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_bounded(&rng, 1 + i % 15);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_bounded/1..15", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += xoshiro256ss_bernoulli_threshold(&rng, threshold);
+  }
+  BenchStop(&bench, &timer, "xoshiro256ss_bernoulli_threshold/0.9", OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += binomial_distribution(re, 16, 0.5);
+  }
+  BenchStop(&bench, &timer, "binomial_distribution/16/0.5", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += binomial_distribution(re, 1000000, 0.3);
+  }
+  BenchStop(&bench, &timer, "binomial_distribution/1000000/0.3", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += poisson_distribution(re, 4.0);
+  }
+  BenchStop(&bench, &timer, "poisson_distribution/4", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += poisson_distribution(re, 1000.0);
+  }
+  BenchStop(&bench, &timer, "poisson_distribution/1000", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += normal_distribution(re, 0.0, 1.0) < 0.0;
+  }
+  BenchStop(&bench, &timer, "normal_distribution", SLOW_OPS);
+
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS; ++i) {
+    benchSink += discrete_distribution(
+        re, WEIGHTS, sizeof(WEIGHTS) / sizeof(WEIGHTS[0]));
+  }
+  BenchStop(&bench, &timer, "discrete_distribution/8", SLOW_OPS);
+
+  alias_table_t *table =
+      alias_table_ctor(WEIGHTS, sizeof(WEIGHTS) / sizeof(WEIGHTS[0]));
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += alias_table_sample(table, re);
+  }
+  BenchStop(&bench, &timer, "alias_table_sample/8", OPS);
+  alias_table_dtor(table);
+
+  double *weights = malloc(ALIAS_WEIGHTS * sizeof(double));
+  for (size_t i = 0; i < ALIAS_WEIGHTS; ++i) {
+    weights[i] = 1 + i % 7;
+  }
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < SLOW_OPS / ALIAS_WEIGHTS; ++i) {
+    benchSink += discrete_distribution(re, weights, ALIAS_WEIGHTS);
+  }
+  BenchStop(&bench, &timer, "discrete_distribution/1024",
+            SLOW_OPS / ALIAS_WEIGHTS);
+  table = alias_table_ctor(weights, ALIAS_WEIGHTS);
+  BenchStart(&timer);
+  for (uint32_t i = 0; i < OPS; ++i) {
+    benchSink += alias_table_sample(table, re);
+  }
+  BenchStop(&bench, &timer, "alias_table_sample/1024", OPS);
+  alias_table_dtor(table);
+  free(weights);
+
+  random_engine_dtor(re);
+  BenchFinish(&bench);
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "bench.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core/row_kernel.h"
+#include "random.h"
+
+#define ROWS 4096
+#define LENGTH UINT8_MAX
+// Roughly the number of cells visited by each benchmark
+#define CELLS_PER_BENCH (1 << 25)
+
+static const RowKernel *KERNELS[] = {&RowKernelScalar, &RowKernelSse41,
+                                     &RowKernelAvx2, &RowKernelNeon};
+
+// Rows of a board in the middle of a game: about half of the cells are
+// empty, tiles are small and often equal to their neighbors
+static uint8_t exponents[ROWS][LENGTH];
+static uint64_t values[ROWS][LENGTH];
+static uint8_t row8[LENGTH];
+static uint64_t row64[LENGTH];
+
+int main(int argc, char **argv) {
+  Bench bench;
+  if (!BenchInit(&bench, "row_kernel", argc, argv)) {
+    return 1;
+  }
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+  for (uint32_t r = 0; r < ROWS; ++r) {
+    for (uint16_t i = 0; i < LENGTH; ++i) {
+      exponents[r][i] = bernoulli_distribution(re, 0.5)
+                            ? uniform_int_distribution(re, 1, 6)
+                            : 0;
+      values[r][i] = exponents[r][i] ? (uint64_t)1 << exponents[r][i] : 0;
+    }
+  }
+  random_engine_dtor(re);
+
+  char name[64];
+  BenchTimer timer;
+  uint32_t rounds = CELLS_PER_BENCH / ((uint64_t)ROWS * LENGTH);
+  if (rounds == 0) {
+    rounds = 1;
+  }
+  uint64_t ops = (uint64_t)rounds * ROWS;
+  uint64_t score = 0;
+  for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); ++k) {
+    const RowKernel *kernel = KERNELS[k];
+    if (!kernel->supported()) {
+      continue;
+    }
+    // Rows are copied before every move, as `GridRestore` in the game bench
+    snprintf(name, sizeof(name), "RowMove64/%s/%u", kernel->name, LENGTH);
+    BenchStart(&timer);
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (uint32_t i = 0; i < ROWS; ++i) {
+        memcpy(row64, values[i], sizeof(row64));
+        benchSink += kernel->move64(row64, LENGTH, &score);
+      }
+    }
+    BenchStop(&bench, &timer, name, ops);
+
+    snprintf(name, sizeof(name), "RowMove8/%s/%u", kernel->name, LENGTH);
+    BenchStart(&timer);
+    for (uint32_t r = 0; r < rounds; ++r) {
+      for (uint32_t i = 0; i < ROWS; ++i) {
+        memcpy(row8, exponents[i], sizeof(row8));
+        benchSink += kernel->move8(row8, LENGTH, &score);
+      }
+    }
+    BenchStop(&bench, &timer, name, ops);
+  }
+  benchSink += score;
+  BenchFinish(&bench);
+  return 0;
+}
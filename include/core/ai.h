@@ -0,0 +1,116 @@
+#pragma once
+#ifndef R2048_CORE_AI_H
+#define R2048_CORE_AI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "game.h"
+#include "transposition.h"
+
+/**
+ * Heuristic evaluating a single line (row or column) of a 4x4 board
+ *
+ * @param line exponents of the line cells, 0 for an empty cell
+ * @return score of the line, higher is better
+ */
+typedef double (*AiHeuristicFn)(const uint8_t line[BITBOARD_SIZE]);
+
+typedef struct AiHeuristic {
+  AiHeuristicFn evaluate; ///< Line evaluation function
+  double weight;          ///< Factor applied to the result of `evaluate`
+} AiHeuristic;
+
+typedef struct AiConfig {
+  uint8_t depth; ///< Number of moves to look ahead
+  double probability_cutoff; ///< Chance nodes reached with a lower probability
+                             ///< are evaluated instead of expanded
+  const AiHeuristic *heuristics; ///< Heuristics summed over every line
+  uint8_t n_heuristics;          ///< Number of heuristics
+  TranspositionTable table; ///< Table shared with other solvers, NULL to
+                            ///< give the solver a table of its own
+} AiConfig;
+
+typedef struct AiSolver {
+  AiConfig config;
+  float *lineScores; // weighted heuristic score of every possible line
+  TranspositionTable table;
+  bool ownsTable;
+} *AiSolver;
+
+/**
+ * Score 1 for every line, keeps a living board above a lost one
+ */
+double AiHeuristicAlive(const uint8_t line[BITBOARD_SIZE]);
+
+/**
+ * Number of empty cells of the line
+ */
+double AiHeuristicEmpty(const uint8_t line[BITBOARD_SIZE]);
+
+/**
+ * Number of merges available in the line, bonus for long runs of equal tiles
+ */
+double AiHeuristicMerges(const uint8_t line[BITBOARD_SIZE]);
+
+/**
+ * Penalty (negative score) for lines that are not sorted in either direction
+ */
+double AiHeuristicMonotonicity(const uint8_t line[BITBOARD_SIZE]);
+
+/**
+ * Penalty (negative score) growing with the tiles of the line, favours boards
+ * that keep few large tiles
+ */
+double AiHeuristicSum(const uint8_t line[BITBOARD_SIZE]);
+
+/**
+ * Default configuration: depth 3 with the built-in heuristics
+ *
+ * @return default solver configuration
+ */
+AiConfig AiDefaultConfig(void);
+
+/**
+ * Initialize a solver with the given configuration
+ *
+ * @param[out] solver pointer to the solver to be initialized
+ * @param[in] config configuration, the heuristics array and the table must
+ * outlive the solver
+ * @note
+ * Solvers sharing a table must use the same heuristics and cutoff, or they
+ * will read each other's scores.
+ **/
+void AiSolverInit(AiSolver *solver, const AiConfig *config);
+
+/**
+ * Find the best move of a bitboard using depth-limited expectimax
+ *
+ * @param[in] solver solver to search with
+ * @param board board to search from
+ * @param[out] direction best direction
+ * @return true if a move was found, false if no move is possible
+ **/
+bool AiSolverBestMoveBitboard(AiSolver solver, Bitboard board,
+                              Direction *direction);
+
+/**
+ * Find the best move of a game using depth-limited expectimax
+ *
+ * @param[in] solver solver to search with
+ * @param[in] game game to search from, must be 4x4
+ * @param[out] direction best direction
+ * @return true if a move was found, false if no move is possible or the grid
+ * can not be packed into a bitboard
+ **/
+bool AiSolverBestMove(AiSolver solver, Game game, Direction *direction);
+
+/**
+ * Free the memory allocated for the solver
+ *
+ * @param[out] solver pointer to the solver to be freed
+ **/
+void AiSolverFree(AiSolver *solver);
+
+#endif
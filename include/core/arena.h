@@ -0,0 +1,61 @@
+#pragma once
+#ifndef R2048_CORE_ARENA_H
+#define R2048_CORE_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Alignment of the blocks handed out by an arena, that of `malloc`
+ */
+#define ARENA_ALIGNMENT 16
+
+/**
+ * Memory handed out block after block from a single allocation, and released
+ * all at once. Allocating is a bump of `used`, blocks are never freed one by
+ * one.
+ */
+typedef struct Arena {
+  uint8_t *base;   ///< Start of the memory, aligned to `ARENA_ALIGNMENT`
+  size_t capacity; ///< Bytes available from `base`
+  size_t used;     ///< Bytes handed out, a mark to rewind to
+} *Arena;
+
+/**
+ * Initialize an arena holding the given number of bytes
+ *
+ * @param[out] arena pointer to the arena to be initialized
+ * @param capacity number of bytes the arena can hand out, block padding
+ * included
+ * @return false if the memory could not be allocated, `*arena` is NULL then
+ **/
+bool ArenaInit(Arena *arena, size_t capacity);
+
+/**
+ * Hand out a block of memory, aligned to `ARENA_ALIGNMENT`
+ *
+ * @param[in] arena arena to take the block from
+ * @param bytes size of the block
+ * @return the block, uninitialized, NULL if the arena is full
+ **/
+void *ArenaAlloc(Arena arena, size_t bytes);
+
+/**
+ * Take back every block handed out after a mark, the blocks must not be used
+ * anymore
+ *
+ * @param[in] arena arena to rewind
+ * @param mark value of `used` when the first block to take back was handed
+ * out, 0 to empty the arena
+ **/
+void ArenaRewind(Arena arena, size_t mark);
+
+/**
+ * Free the memory of the arena and every block handed out
+ *
+ * @param[out] arena pointer to the arena to be freed
+ **/
+void ArenaFree(Arena *arena);
+
+#endif
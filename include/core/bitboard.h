@@ -0,0 +1,122 @@
+#pragma once
+#ifndef R2048_CORE_BITBOARD_H
+#define R2048_CORE_BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+#include "grid.h"
+#include "random.h"
+
+/**
+ * Packed 4x4 board. Every cell is stored as a 4-bit exponent (0 for an empty
+ * cell, `n` for a tile of value `2^n`), cell `i` of the grid lives in bits
+ * `[4 * i, 4 * i + 4)`.
+ */
+typedef uint64_t Bitboard;
+
+/**
+ * Size of the grid that can be packed into a bitboard
+ */
+#define BITBOARD_SIZE 4
+
+/**
+ * Highest exponent a bitboard cell can hold (tile 32768). Two tiles of this
+ * value never merge, since the result would not fit in a cell.
+ */
+#define BITBOARD_MAX_EXPONENT 15
+
+/**
+ * Build the row lookup tables used by the bitboard moves
+ *
+ * @note
+ * The tables are built lazily on first move, call this once before sharing
+ * bitboards between threads.
+ **/
+void BitboardInit(void);
+
+/**
+ * Pack a grid into a bitboard
+ *
+ * @param[in] grid grid to pack, must be 4x4
+ * @param[out] board packed board
+ * @return true if the grid was packed, false if it is not 4x4 or holds a tile
+ * above `2^BITBOARD_MAX_EXPONENT`
+ **/
+bool BitboardFromGrid(Grid grid, Bitboard *board);
+
+/**
+ * Unpack a bitboard into a grid
+ *
+ * @param board board to unpack
+ * @param[out] grid 4x4 grid to write the cells to
+ **/
+void BitboardToGrid(Bitboard board, Grid grid);
+
+/**
+ * Get the exponent of the cell at the given index
+ *
+ * @param board board to read
+ * @param index index of the cell
+ * @return exponent of the cell, 0 if the cell is empty
+ **/
+static inline uint8_t BitboardGetCell(Bitboard board, uint8_t index) {
+  return (board >> (4 * index)) & 0xF;
+}
+
+/**
+ * Transpose the board, rows become columns
+ *
+ * @param board board to transpose
+ * @return transposed board
+ **/
+static inline Bitboard BitboardTranspose(Bitboard board) {
+  Bitboard a1 = board & 0xF0F00F0FF0F00F0FULL;
+  Bitboard a2 = board & 0x0000F0F00000F0F0ULL;
+  Bitboard a3 = board & 0x0F0F00000F0F0000ULL;
+  Bitboard a = a1 | (a2 << 12) | (a3 >> 12);
+  Bitboard b1 = a & 0xFF00FF0000FF00FFULL;
+  Bitboard b2 = a & 0x00FF00FF00000000ULL;
+  Bitboard b3 = a & 0x00000000FF00FF00ULL;
+  return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+/**
+ * Move the tiles in the given direction, same rules as `GameMove`
+ *
+ * @param[in,out] board board to move the tiles in
+ * @param direction direction to move the tiles
+ * @param[in,out] score incremented by the value of every merged tile, may be
+ * NULL
+ * @return true if the tiles were moved, false otherwise
+ **/
+bool BitboardMove(Bitboard *board, Direction direction, uint64_t *score);
+
+/**
+ * Add a random tile to the board, draws the same numbers from the engine and
+ * picks the same cell as `GameAddRandomTile`
+ *
+ * @param[in,out] board board to add the tile to
+ * @param[in] re random engine to draw from
+ * @return index of inserted tile, -1 if no cell available
+ **/
+int BitboardAddRandomTile(Bitboard *board, random_engine_t *re);
+
+/**
+ * Count the empty cells of the board
+ *
+ * @param board board to check
+ * @return number of empty cells
+ **/
+uint8_t BitboardCountEmpty(Bitboard board);
+
+/**
+ * Check if there are any tile matches available
+ *
+ * @param board board to check
+ * @return true if there are matches available, false otherwise
+ **/
+bool BitboardTileMatchesAvailable(Bitboard board);
+
+#endif
@@ -4,42 +4,113 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include "arena.h"
 #include "grid.h"
+#include "history.h"
 #include "random.h"
+#include "xoshiro256ss.h"
 
 typedef enum { LEFT = 0, UP = 1, RIGHT = 2, DOWN = 3 } Direction;
 
-typedef struct HistoryState {
-  uint64_t score;
-  uint64_t *cells;
-} HistoryState;
+/**
+ * Movement of a single tile during a move
+ */
+typedef struct TileMove {
+  uint16_t from;  ///< Index of the tile before the move
+  uint16_t to;    ///< Index of the tile after the move
+  bool merged;    ///< Whether the tile merged with another one at `to`
+  uint64_t value; ///< Value of the cell at `to` after the move
+} TileMove;
 
 typedef struct Game {
   Grid grid;
-  random_engine_t * re;
+  random_engine_t * re; // engine of the caller, NULL to draw from `rng`
+  xoshiro256ss_t rng;    // embedded engine, drawn from inline
   uint64_t score;
   uint32_t moves;
-  // [TODO] Add history
+  History history;       // states to undo and redo, NULL if not recorded
+  struct ReplayRecorder *recorder; // replay being written, NULL if none
 } *Game;
 
 /**
- * Initialize a game with the given width and height
+ * Initialize a game with the given width and height, seeded from the default
+ * random device
  *
  * @param[out] game pointer to the game to be initialized
- * @param size size of the grid
+ * @param size size of the grid, any size up to 255x255 is supported
  **/
 void GameInit(Game *game, uint8_t size);
 
+/**
+ * Initialize a game that draws its tiles from its embedded engine, seeded
+ * with the given seed. Spawning tiles then needs no engine dispatch.
+ *
+ * @param[out] game pointer to the game to be initialized
+ * @param size size of the grid
+ * @param seed seed of the embedded engine, the same seed always deals the
+ * same tiles, like an `Xoshiro256ssEngine.ctor_seed` engine would
+ **/
+void GameInitWithSeed(Game *game, uint8_t size, uint64_t seed);
+
+/**
+ * Number of bytes taken by a game: the game, its grid, its cells and the
+ * empty cell bitmap of the grid are laid out in a single block, padded to
+ * `ARENA_ALIGNMENT` so that games fit back to back in an arena
+ *
+ * @param size size of the grid
+ * @return number of bytes of the block
+ **/
+size_t GameFootprint(uint8_t size);
+
+/**
+ * Initialize a game in memory taken from an arena, like `GameInitWithSeed`.
+ * The game is released with the arena and must not be given to `GameFree`.
+ *
+ * @param[out] game pointer to the game to be initialized
+ * @param[in] arena arena to take `GameFootprint(size)` bytes from
+ * @param size size of the grid
+ * @param seed seed of the embedded engine
+ * @return false if the arena is full, `*game` is NULL then
+ **/
+bool GameInitIn(Game *game, Arena arena, uint8_t size, uint64_t seed);
+
+/**
+ * Initialize a game that draws its tiles from the given random engine
+ *
+ * @param[out] game pointer to the game to be initialized
+ * @param size size of the grid
+ * @param[in] re random engine, still owned by the caller: it is not released
+ * by `GameFree` and can be shared by consecutive games
+ **/
+void GameInitWithEngine(Game *game, uint8_t size, random_engine_t *re);
+
 /**
  * Move the tiles in the given direction
  *
  * @param[in] game game to move the tiles in
  * @param dir direction to move the tiles
+ * @param[out] diff array of `grid->length` entries, receives the index every
+ * cell moved to (its own index for cells that did not move). May be NULL.
  * @return true if the tiles were moved, false otherwise
  */
 bool GameMove(Game game, Direction direction, uint16_t * diff);
 
+/**
+ * Move the tiles in the given direction and list the tiles that moved
+ *
+ * @param[in] game game to move the tiles in
+ * @param direction direction to move the tiles
+ * @param[out] trace array of `grid->length` entries, receives one entry per
+ * tile that slid or merged. The entries of a line follow the line order, and
+ * both tiles of a merge are listed, including the one that stays in place.
+ * @param[out] n_trace number of entries written to `trace`
+ * @return true if the tiles were moved, false otherwise
+ */
+bool GameMoveTrace(Game game, Direction direction, TileMove *trace,
+                   uint16_t *n_trace);
+
 /**
  * Add a random tile to the game
  *
@@ -65,6 +136,118 @@ bool GameAddRandomTiles(Game game, uint16_t n_tiles);
  */
 bool GameTileMatchesAvailable(Game game);
 
+/**
+ * Check if any move is left, answered from the summary kept by the grid
+ *
+ * @param[in] game game to check
+ * @return false if the game is over, true otherwise
+ */
+bool GameCanMove(Game game);
+
+/**
+ * Start a new game in place, with two random tiles: the grid is emptied and
+ * the score, moves and history are reset. Nothing is allocated, the engine of
+ * the game carries on, reseed `rng` before to deal the tiles of a given seed.
+ *
+ * @param[in] game game to reset
+ **/
+void GameReset(Game game);
+
+/**
+ * Start recording the moves and spawns of the game, to undo and redo them.
+ * The current state is the first one of the history.
+ *
+ * @param[in] game game to record
+ * @param capacity number of moves that can be undone, older ones are dropped
+ * a keyframe interval at a time
+ * @return false if the history could not be allocated
+ **/
+bool GameRecordHistory(Game game, uint32_t capacity);
+
+/**
+ * Go back to the state before the last move or spawn. The keyframe at or
+ * before that state is restored and the moves after it are played again.
+ *
+ * @param[in] game game to undo the last move of
+ * @return false if there is nothing to undo or the history is not recorded
+ **/
+bool GameUndo(Game game);
+
+/**
+ * Play again the last move or spawn undone. Moving or spawning a tile drops
+ * the states that could be redone.
+ *
+ * @param[in] game game to redo the move of
+ * @return false if there is nothing to redo or the history is not recorded
+ **/
+bool GameRedo(Game game);
+
+/**
+ * Start writing a replay of the game from its current state, see
+ * `core/replay.h`. Moves, spawns, undos, redos and resets are recorded until
+ * the replay is stopped or the game freed.
+ *
+ * @param[in] game game to record, drawing its tiles from its embedded engine
+ * @param[in] stream stream to write the replay to, left open
+ * @return false if the game draws from another engine or the stream could
+ * not be written to
+ **/
+bool GameRecordReplay(Game game, FILE *stream);
+
+/**
+ * Stop writing the replay of the game, the replay is flushed
+ *
+ * @param[in] game game recorded
+ * @return false if writing to the stream failed
+ **/
+bool GameStopReplay(Game game);
+
+/**
+ * Games of a given size, allocated up front from an arena and reused: a
+ * released game is pushed on the free list, and handed out again reset
+ */
+typedef struct GamePool {
+  uint8_t size;      ///< Size of the grid of every game
+  uint32_t capacity; ///< Number of games of the pool
+  uint32_t n_free;   ///< Number of games on the free list
+  Game *free;        ///< Free list, the last released game on top
+  Arena arena;       ///< Memory of the games and of the free list
+} *GamePool;
+
+/**
+ * Initialize a pool of games
+ *
+ * @param[out] pool pointer to the pool to be initialized
+ * @param size size of the grid of every game
+ * @param capacity number of games, all allocated at once
+ * @return false if the pool could not be allocated, `*pool` is NULL then
+ **/
+bool GamePoolInit(GamePool *pool, uint8_t size, uint32_t capacity);
+
+/**
+ * Take a game from the pool and start a new game on it
+ *
+ * @param[in] pool pool to take the game from
+ * @param seed seed of the embedded engine of the game
+ * @return the game, NULL if every game of the pool is in use
+ **/
+Game GamePoolAcquire(GamePool pool, uint64_t seed);
+
+/**
+ * Give a game back to the pool
+ *
+ * @param[in] pool pool the game was taken from
+ * @param[in] game game to give back, must not be used anymore
+ **/
+void GamePoolRelease(GamePool pool, Game game);
+
+/**
+ * Free the memory of the pool and of all of its games
+ *
+ * @param[out] pool pointer to the pool to be freed
+ **/
+void GamePoolFree(GamePool *pool);
+
 /**
  * Free the memory allocated for the game
  *
@@ -0,0 +1,126 @@
+#pragma once
+#ifndef R2048_CORE_GAME_BATCH_H
+#define R2048_CORE_GAME_BATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "game.h"
+
+/**
+ * Largest grid size of a batch. Lines slide branch-free, with a cost growing
+ * with the cube of the size: larger grids are better served by `GameMove`.
+ */
+#define GAME_BATCH_MAX_SIZE 16
+
+/**
+ * Boards advanced together, `stride` is a multiple of it. Loops over the
+ * boards of a block have a constant trip count and vectorize without
+ * remainder.
+ */
+#define GAME_BATCH_BLOCK 64
+
+/**
+ * Games advanced together, stored as structure of arrays in a single
+ * cache-aligned buffer. Per-board arrays have `stride` entries, one per
+ * board, and the entries of a given cell of every board are contiguous, so
+ * the loops over the boards vectorize. Cells hold the exponent of their tile,
+ * a byte, to fit as many boards as possible in a vector register.
+ */
+typedef struct GameBatch {
+  uint8_t size;    ///< Size of every grid
+  uint16_t length; ///< Number of cells of a grid
+  uint32_t count;  ///< Number of boards
+  uint32_t stride; ///< Entries per board array, `count` rounded up to
+                   ///< `GAME_BATCH_BLOCK`, padding boards stay empty
+  uint8_t *cells;  ///< Exponent of the tile of cell `i` of board `b`, 0 if
+                   ///< empty, at `cells[i * stride + b]`
+  uint64_t *score; ///< Score of board `b` at `score[b]`
+  uint32_t *moves; ///< Moves played on board `b` at `moves[b]`
+  uint64_t *rng;   ///< Word `w` of the xoshiro256** state of board `b` at
+                   ///< `rng[w * stride + b]`
+  void *buffer;    ///< Allocation holding every array
+} *GameBatch;
+
+/**
+ * Initialize a batch of games, each with two random tiles
+ *
+ * @param[out] batch pointer to the batch to be initialized
+ * @param size size of every grid, up to `GAME_BATCH_MAX_SIZE`
+ * @param count number of boards
+ * @param seed seed of the boards: board `b` draws the stream of an
+ * `Xoshiro256ssEngine.ctor_seed(seed)` engine after `b` jumps
+ * @return false if the size is not supported or the batch could not be
+ * allocated, `*batch` is NULL then
+ **/
+bool GameBatchInit(GameBatch *batch, uint8_t size, uint32_t count,
+                   uint64_t seed);
+
+/**
+ * Empty a board and start a new game on it, with two random tiles. The
+ * random state of the board carries on.
+ *
+ * @param[in] batch batch of the board
+ * @param board index of the board
+ **/
+void GameBatchReset(GameBatch batch, uint32_t board);
+
+/**
+ * Copy the cells of a board
+ *
+ * @param[in] batch batch of the board
+ * @param board index of the board
+ * @param[out] cells array of `length` cells, in the order of `Grid` cells
+ **/
+void GameBatchGetBoard(GameBatch batch, uint32_t board, uint64_t *cells);
+
+/**
+ * Overwrite the cells of a board
+ *
+ * @param[in] batch batch of the board
+ * @param board index of the board
+ * @param[in] cells array of `length` cells, in the order of `Grid` cells
+ **/
+void GameBatchSetBoard(GameBatch batch, uint32_t board, const uint64_t *cells);
+
+/**
+ * Move the tiles of every board, each in its own direction. Boards whose
+ * tiles moved get their score updated and their move count incremented.
+ *
+ * @param[in] batch batch to move
+ * @param[in] directions direction of each board
+ * @param[out] moved receives whether the tiles of each board moved, may be
+ * NULL
+ * @return number of boards whose tiles moved
+ **/
+uint32_t GameBatchMove(GameBatch batch, const Direction *directions,
+                       bool *moved);
+
+/**
+ * Add a random tile to boards, like `GameAddRandomTile`: a 2 with a 90%
+ * chance, a 4 otherwise, on a uniformly picked available cell
+ *
+ * @param[in] batch batch to add the tiles to
+ * @param[in] mask whether to add a tile to each board, NULL for every board
+ * @return number of tiles added, full boards get none
+ **/
+uint32_t GameBatchSpawn(GameBatch batch, const bool *mask);
+
+/**
+ * Check which boards can still move, like `GridAnyCellAvailable ||
+ * GameTileMatchesAvailable` on each of them
+ *
+ * @param[in] batch batch to check
+ * @param[out] alive receives whether each board can still move
+ * @return number of boards that can still move
+ **/
+uint32_t GameBatchAlive(GameBatch batch, bool *alive);
+
+/**
+ * Free the memory allocated for the batch
+ *
+ * @param[out] batch pointer to the batch to be freed
+ **/
+void GameBatchFree(GameBatch *batch);
+
+#endif
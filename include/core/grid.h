@@ -5,11 +5,25 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
+/**
+ * Number of 64-bit words of the empty cell bitmap of a grid of `length` cells
+ **/
+#define GRID_EMPTY_WORDS(length) (((size_t)(length) + 63) / 64)
+
+/**
+ * Cells of a grid, with a summary kept up to date by the game as tiles move
+ * and spawn. Code writing the cells itself must call `GridSync` afterwards.
+ **/
 struct Grid {
     uint8_t size;
     uint64_t * cells;
     uint16_t length;
+    uint64_t * empty;   // bitmap of the empty cells, cell i at bit i % 64 of word i / 64
+    uint16_t n_empty;   // number of empty cells
+    uint64_t maxTile;   // largest tile, 0 when the grid is empty
+    int8_t hasPair;     // whether two adjacent cells hold the same tile, -1 if unknown
 };
 
 typedef struct Grid * Grid;
@@ -22,6 +36,38 @@ typedef struct Grid * Grid;
  **/
 void GridInit(Grid * grid, uint8_t size);
 
+/**
+ * Recompute the summary of the grid from its cells
+ *
+ * @param[in,out] grid grid whose cells were written directly
+ **/
+void GridSync(Grid grid);
+
+/**
+ * Copy the cells of a grid and their summary to a grid of the same size
+ *
+ * @param[out] to grid to copy to
+ * @param[in] from grid to copy
+ **/
+void GridCopy(Grid to, Grid from);
+
+/**
+ * Set the cell at the given index, keeping the summary of the grid up to date
+ *
+ * @param[in,out] grid grid to write to
+ * @param index index of the cell to set
+ * @param value tile to put in the cell, 0 to empty it
+ **/
+void GridSetCell(Grid grid, uint16_t index, uint64_t value);
+
+/**
+ * Check if two adjacent cells hold the same tile
+ *
+ * @param[in,out] grid grid to check, caches the answer until the next move
+ * @return true if two adjacent tiles can merge, false otherwise
+ **/
+bool GridHasPair(Grid grid);
+
 /**
  * Check if the cell at the given index is available
  *
@@ -53,6 +99,24 @@ bool GridAnyCellAvailable(Grid grid);
  **/
 uint64_t GridGetAvailableCells(Grid grid, uint16_t * array, uint16_t size);
 
+/**
+ * Count the available cells of the grid
+ *
+ * @param[in] grid grid to count the available cells of
+ * @return number of available cells
+ **/
+uint16_t GridCountAvailableCells(Grid grid);
+
+/**
+ * Get the index of the n-th available cell, in index order
+ *
+ * @param[in] grid grid to search
+ * @param n rank of the available cell, must be less than the number of
+ * available cells
+ * @return index of the cell
+ **/
+uint16_t GridGetNthAvailableCell(Grid grid, uint16_t n);
+
 /**
  * Free the memory allocated for the grid
  *
@@ -0,0 +1,131 @@
+#pragma once
+#ifndef R2048_CORE_HISTORY_H
+#define R2048_CORE_HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Moves between keyframes: undoing restores the keyframe at or before the
+ * target and replays at most this many deltas
+ */
+#define HISTORY_KEYFRAME_INTERVAL 32
+
+/**
+ * Direction of a delta that only spawned a tile
+ */
+#define HISTORY_NO_MOVE UINT8_MAX
+
+/**
+ * Change of a game by a move and the tile spawned after it. Moves are
+ * deterministic, so replaying the direction and the spawn on the previous
+ * state gives the next one, score included.
+ */
+typedef struct HistoryDelta {
+  uint16_t spawnIndex;   ///< Cell of the spawned tile
+  uint8_t direction;     ///< `Direction` moved, `HISTORY_NO_MOVE` if none
+  uint8_t spawnExponent; ///< Exponent of the spawned tile, 0 if none
+} HistoryDelta;
+
+/**
+ * States of a game as a ring buffer of deltas, with a full copy of the game
+ * every `HISTORY_KEYFRAME_INTERVAL` deltas. States are numbered from the
+ * start of the history. When the buffer is full, the oldest keyframe is
+ * dropped with the deltas that follow it.
+ */
+typedef struct History {
+  uint16_t length;         ///< Number of cells of a keyframe
+  uint32_t capacity;       ///< Number of deltas kept, a multiple of the interval
+  uint32_t n_keyframes;    ///< Number of keyframes kept
+  uint64_t first;          ///< Oldest state kept, always at a keyframe
+  uint64_t position;       ///< Current state
+  uint64_t end;            ///< State after the last delta, redo goes up to it
+  HistoryDelta *deltas;    ///< Delta from state `s` at `deltas[s % capacity]`
+  uint64_t *keyframeState; ///< State of each keyframe, `UINT64_MAX` if unset
+  uint64_t *keyframeScore; ///< Score of each keyframe
+  uint32_t *keyframeMoves; ///< Moves of each keyframe
+  uint64_t *keyframeCells; ///< Cells of each keyframe, `length` each
+} *History;
+
+/**
+ * Initialize an empty history
+ *
+ * @param[out] history pointer to the history to be initialized
+ * @param length number of cells of the grid
+ * @param capacity number of deltas to keep, rounded up to a multiple of
+ * `HISTORY_KEYFRAME_INTERVAL`
+ * @return false if the history could not be allocated, `*history` is NULL
+ * then
+ **/
+bool HistoryInit(History *history, uint16_t length, uint32_t capacity);
+
+/**
+ * Forget every state, the next one recorded is state 0
+ *
+ * @param[in] history history to clear
+ **/
+void HistoryClear(History history);
+
+/**
+ * Save a keyframe of the current state if it falls on the interval and has
+ * none yet. Called before the grid changes.
+ *
+ * @param[in] history history to save to
+ * @param[in] cells cells of the grid
+ * @param score score of the game
+ * @param moves moves of the game
+ **/
+void HistoryCheckpoint(History history, const uint64_t *cells, uint64_t score,
+                       uint32_t moves);
+
+/**
+ * Append a move to the current state, dropping the states that could be
+ * redone
+ *
+ * @param[in] history history to append to
+ * @param direction direction moved
+ **/
+void HistoryRecordMove(History history, uint8_t direction);
+
+/**
+ * Record a spawned tile: part of the last delta if it is a move without a
+ * spawn yet, a delta of its own otherwise
+ *
+ * @param[in] history history to record to
+ * @param index cell of the tile
+ * @param exponent exponent of the tile
+ **/
+void HistoryRecordSpawn(History history, uint16_t index, uint8_t exponent);
+
+/**
+ * Get the delta from a state to the next
+ *
+ * @param[in] history history to search
+ * @param state state the delta applies to, from `first` to `end - 1`
+ * @return the delta
+ **/
+const HistoryDelta *HistoryDeltaAt(History history, uint64_t state);
+
+/**
+ * Restore the keyframe at or before a state
+ *
+ * @param[in] history history to search
+ * @param state state to restore, from `first` to `end`
+ * @param[out] cells receives the cells of the keyframe
+ * @param[out] score receives the score of the keyframe
+ * @param[out] moves receives the moves of the keyframe
+ * @return state of the keyframe, the deltas from it up to `state` are to be
+ * replayed
+ **/
+uint64_t HistoryRestoreKeyframe(History history, uint64_t state,
+                                uint64_t *cells, uint64_t *score,
+                                uint32_t *moves);
+
+/**
+ * Free the memory allocated for the history
+ *
+ * @param[out] history pointer to the history to be freed
+ **/
+void HistoryFree(History *history);
+
+#endif
@@ -0,0 +1,203 @@
+#pragma once
+#ifndef R2048_CORE_REPLAY_H
+#define R2048_CORE_REPLAY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "game.h"
+
+/*
+ * Replay file format, little-endian:
+ *
+ *   header   "R2048RPL", version (1 byte), grid size (1 byte), engine name
+ *            (1 byte length and the name), state
+ *   state    score (varint), moves (varint), the 256-bit xoshiro256** state
+ *            (4 x 8 bytes), the exponent of every cell (1 byte each, 0 if
+ *            empty)
+ *   records  varint `count << 3 | kind`, then by kind:
+ *            - `REPLAY_MOVES_SPAWNS`, `REPLAY_MOVES`: `count` directions, 2
+ *              bits each, 4 per byte from the low bits
+ *            - `REPLAY_SPAWNS`: nothing
+ *            - `REPLAY_KEYFRAME`, `REPLAY_STATE`: moves recorded before
+ *              (varint), state
+ *
+ * Spawns are not stored: they are drawn again from the engine state.
+ */
+
+/// First bytes of a replay
+#define REPLAY_MAGIC "R2048RPL"
+/// Version of the format written
+#define REPLAY_VERSION 1
+/// Moves between the keyframes written by a recorder
+#define REPLAY_KEYFRAME_INTERVAL 4096
+/// Bytes of directions buffered before a record is written
+#define REPLAY_RUN_BYTES 256
+
+/**
+ * Kind of a record of a replay
+ */
+typedef enum {
+  REPLAY_MOVES_SPAWNS = 0, ///< Moves, each followed by a spawn
+  REPLAY_MOVES = 1,        ///< Moves without a spawn
+  REPLAY_SPAWNS = 2,       ///< Spawns without a move
+  REPLAY_KEYFRAME = 3,     ///< State reached by the moves, checked on replay
+  REPLAY_STATE = 4,        ///< State set by an undo, a redo or a reset
+} ReplayKind;
+
+/**
+ * Replay written while a game is played, to a stream. Moves are buffered
+ * into records of consecutive moves of the same kind.
+ */
+typedef struct ReplayRecorder {
+  FILE *stream;      ///< Stream written to, owned by the caller
+  uint64_t played;   ///< Moves recorded
+  uint64_t keyframe; ///< Moves recorded at the last keyframe or state
+  int8_t pending;    ///< Direction of the last move, until its spawn, -1 if
+                     ///< none
+  ReplayKind kind;   ///< Kind of the record buffered
+  uint32_t count;    ///< Moves or spawns of the record buffered
+  uint8_t run[REPLAY_RUN_BYTES]; ///< Directions of the record buffered
+  uint8_t *state;    ///< Buffer encoding states
+  bool failed;       ///< Whether writing to the stream failed
+} *ReplayRecorder;
+
+/**
+ * Start a replay of the current state of a game
+ *
+ * @param[out] recorder pointer to the recorder to be initialized
+ * @param[in] game game to record, drawing its tiles from its embedded engine
+ * @param[in] stream stream to write the replay to
+ * @return false if the game draws from another engine, or the header could
+ * not be written, `*recorder` is NULL then
+ **/
+bool ReplayRecorderInit(ReplayRecorder *recorder, Game game, FILE *stream);
+
+/**
+ * Write a keyframe if the moves recorded reached the interval. Called before
+ * each move.
+ *
+ * @param[in] recorder recorder to write to
+ * @param[in] game game recorded
+ **/
+void ReplayRecorderCheckpoint(ReplayRecorder recorder, Game game);
+
+/**
+ * Record a move that moved the tiles
+ *
+ * @param[in] recorder recorder to write to
+ * @param direction direction moved
+ **/
+void ReplayRecordMove(ReplayRecorder recorder, Direction direction);
+
+/**
+ * Record a spawned tile
+ *
+ * @param[in] recorder recorder to write to
+ **/
+void ReplayRecordSpawn(ReplayRecorder recorder);
+
+/**
+ * Record the whole state of a game, set other than by moves and spawns
+ *
+ * @param[in] recorder recorder to write to
+ * @param[in] game game recorded
+ **/
+void ReplayRecordState(ReplayRecorder recorder, Game game);
+
+/**
+ * Write the records buffered and flush the stream
+ *
+ * @param[in] recorder recorder to flush
+ * @return false if writing to the stream failed since the start of the replay
+ **/
+bool ReplayRecorderFlush(ReplayRecorder recorder);
+
+/**
+ * Flush the recorder and free it, the stream is left open
+ *
+ * @param[out] recorder pointer to the recorder to be freed
+ * @return false if writing to the stream failed
+ **/
+bool ReplayRecorderFree(ReplayRecorder *recorder);
+
+/**
+ * Game played again from a replay, headless
+ */
+typedef struct ReplayPlayer {
+  uint8_t *data;        ///< Bytes of the replay
+  size_t size;          ///< Number of bytes of the replay
+  Game game;            ///< Game replayed, with its embedded engine
+  uint64_t played;      ///< Moves played
+  uint64_t n_moves;     ///< Moves of the replay
+  size_t cursor;        ///< Offset of the next record
+  ReplayKind kind;      ///< Kind of the record being played
+  uint32_t remaining;   ///< Moves or spawns left in the record
+  size_t directions;    ///< Offset of the next direction of the record
+  uint8_t shift;        ///< Bit of the next direction in its byte
+  uint32_t n_seeks;     ///< Number of states to seek from
+  uint64_t *seekMoves;  ///< Moves played at each state to seek from
+  size_t *seekOffsets;  ///< Offset of each state to seek from
+  bool failed;          ///< Whether the replay diverged from its keyframes
+} *ReplayPlayer;
+
+/**
+ * Open a replay held in memory, at its first state
+ *
+ * @param[out] player pointer to the player to be initialized
+ * @param[in] data bytes of the replay, copied
+ * @param size number of bytes
+ * @return false if the replay is malformed or for another engine, `*player`
+ * is NULL then
+ **/
+bool ReplayPlayerInit(ReplayPlayer *player, const void *data, size_t size);
+
+/**
+ * Open a replay read from a stream, at its first state
+ *
+ * @param[out] player pointer to the player to be initialized
+ * @param[in] stream stream to read the whole replay from
+ * @return false if the replay could not be read, is malformed or for another
+ * engine, `*player` is NULL then
+ **/
+bool ReplayPlayerLoad(ReplayPlayer *player, FILE *stream);
+
+/**
+ * Play the next move of the replay with the spawn recorded with it, or the
+ * next spawn or state set without a move
+ *
+ * @param[in] player player to step
+ * @return false at the end of the replay, or if the game diverged from the
+ * replay, `failed` is set then
+ **/
+bool ReplayPlayerStep(ReplayPlayer player);
+
+/**
+ * Play the replay to its end
+ *
+ * @param[in] player player to run
+ * @return false if the game diverged from the replay
+ **/
+bool ReplayPlayerRun(ReplayPlayer player);
+
+/**
+ * Go to the state after a given number of moves, from the last keyframe at
+ * or before it
+ *
+ * @param[in] player player to seek
+ * @param move number of moves to have played, up to `n_moves`
+ * @return false if the move is out of the replay, or if the game diverged
+ * from the replay
+ **/
+bool ReplayPlayerSeek(ReplayPlayer player, uint64_t move);
+
+/**
+ * Free the player and its game
+ *
+ * @param[out] player pointer to the player to be freed
+ **/
+void ReplayPlayerFree(ReplayPlayer *player);
+
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef R2048_CORE_ROW_KERNEL_H
+#define R2048_CORE_ROW_KERNEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Slide and merge a row of tile values towards its first cell, in place
+ *
+ * @param[in,out] row cells of the row, 0 for empty cells
+ * @param length number of cells of the row
+ * @param[in,out] score incremented by the value of every merged tile
+ * @return true if the row changed
+ */
+typedef bool (*RowMove64Fn)(uint64_t *row, uint16_t length, uint64_t *score);
+
+/**
+ * Slide and merge a row of tile exponents towards its first cell, in place.
+ * Tiles of exponent `UINT8_MAX` never merge.
+ *
+ * @param[in,out] row exponents of the row, 0 for empty cells
+ * @param length number of cells of the row
+ * @param[in,out] score incremented by the value of every merged tile
+ * @return true if the row changed
+ */
+typedef bool (*RowMove8Fn)(uint8_t *row, uint16_t length, uint64_t *score);
+
+/**
+ * Row kernel implementation for an instruction set
+ */
+typedef struct RowKernel {
+  const char *name;          ///< Name of the instruction set
+  bool (*supported)(void);   ///< Whether the running CPU can use the kernel
+  RowMove64Fn move64;        ///< Kernel for rows of tile values
+  RowMove8Fn move8;          ///< Kernel for rows of tile exponents
+} RowKernel;
+
+/// Portable kernel, one cell at a time
+extern const RowKernel RowKernelScalar;
+/// x86 kernel using SSE4.1, unsupported on other architectures
+extern const RowKernel RowKernelSse41;
+/// x86 kernel using AVX2, unsupported on other architectures
+extern const RowKernel RowKernelAvx2;
+/// AArch64 kernel using NEON, unsupported on other architectures
+extern const RowKernel RowKernelNeon;
+
+/**
+ * Get the fastest kernel supported by the running CPU, selected on first call
+ *
+ * @return the kernel, `RowKernelScalar` if no vector kernel is supported
+ */
+const RowKernel *RowKernelGet(void);
+
+#endif
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef R2048_CORE_TRANSPOSITION_H
+#define R2048_CORE_TRANSPOSITION_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitboard.h"
+#include "game.h"
+#include "grid.h"
+
+/**
+ * Move stored for entries that have no best move (e.g. chance nodes)
+ */
+#define TRANSPOSITION_NO_MOVE 0xFF
+
+/**
+ * Number of consecutive slots probed for a hash, 4 slots fill a cache line
+ */
+#define TRANSPOSITION_BUCKET_SIZE 4
+
+/**
+ * A slot stores `check = hash ^ data` next to `data`. Each word is read and
+ * written atomically, but not both together: a slot torn by a concurrent
+ * store fails the check and reads as a miss.
+ */
+typedef struct TranspositionSlot {
+  _Atomic uint64_t check;
+  _Atomic uint64_t data;
+} TranspositionSlot;
+
+typedef struct TranspositionEntry {
+  float value;   ///< Stored score
+  uint8_t depth; ///< Remaining search depth the score was computed with
+  uint8_t move;  ///< Best direction, `TRANSPOSITION_NO_MOVE` if none
+} TranspositionEntry;
+
+typedef struct TranspositionStats {
+  uint64_t probes;     ///< Number of probes
+  uint64_t hits;       ///< Probes that found a usable entry
+  uint64_t stores;     ///< Number of stores
+  uint64_t overwrites; ///< Stores that evicted an entry of another position
+} TranspositionStats;
+
+typedef struct TranspositionTable {
+  TranspositionSlot *slots;
+  uint64_t mask;
+  _Atomic uint8_t age; // bumped by `TranspositionNewSearch`
+  _Atomic uint64_t probes;
+  _Atomic uint64_t hits;
+  _Atomic uint64_t stores;
+  _Atomic uint64_t overwrites;
+} *TranspositionTable;
+
+/**
+ * Initialize a table with `2^bits` slots
+ *
+ * @param[out] table pointer to the table to be initialized
+ * @param bits base 2 logarithm of the slot count, at least 2
+ * (e.g: 20 for 1M slots, 16 MiB)
+ **/
+void TranspositionInit(TranspositionTable *table, uint8_t bits);
+
+/**
+ * Zobrist hash of a grid. Every (cell index, tile) pair has its own key and
+ * the hash is the XOR of the keys of all non-empty cells.
+ *
+ * @param[in] grid grid to hash
+ * @return hash of the grid cells
+ **/
+uint64_t TranspositionHashGrid(Grid grid);
+
+/**
+ * Zobrist hash of a bitboard, equal to `TranspositionHashGrid` of the
+ * unpacked grid
+ *
+ * @param board board to hash
+ * @return hash of the board cells
+ **/
+uint64_t TranspositionHashBitboard(Bitboard board);
+
+/**
+ * Look up a position, safe to call concurrently with other probes and stores
+ *
+ * @param[in] table table to probe
+ * @param hash hash of the position
+ * @param depth minimum depth of a usable entry
+ * @param[out] entry entry found, untouched on a miss
+ * @return true if an entry of at least the given depth was found
+ **/
+bool TranspositionProbe(TranspositionTable table, uint64_t hash, uint8_t depth,
+                        TranspositionEntry *entry);
+
+/**
+ * Store a position, safe to call concurrently with other probes and stores
+ *
+ * @note
+ * Within the bucket, the slot of the same position is reused, otherwise the
+ * slot of an older search, then the shallowest one is replaced.
+ *
+ * @param[in] table table to store to
+ * @param hash hash of the position
+ * @param[in] entry entry to store
+ **/
+void TranspositionStore(TranspositionTable table, uint64_t hash,
+                        const TranspositionEntry *entry);
+
+/**
+ * Start a new search, entries of previous searches are replaced first
+ *
+ * @param[in] table table to age
+ **/
+void TranspositionNewSearch(TranspositionTable table);
+
+/**
+ * Get the probe and store counters of the table
+ *
+ * @param[in] table table to read the counters of
+ * @return counters since initialization or the last clear
+ **/
+TranspositionStats TranspositionGetStats(TranspositionTable table);
+
+/**
+ * Remove every entry and reset the counters, must not run concurrently with
+ * probes or stores
+ *
+ * @param[in] table table to clear
+ **/
+void TranspositionClear(TranspositionTable table);
+
+/**
+ * Free the memory allocated for the table
+ *
+ * @param[out] table pointer to the table to be freed
+ **/
+void TranspositionFree(TranspositionTable *table);
+
+#endif
@@ -44,7 +44,8 @@ random_device_t *random_device_ctor(void);
  * @param buffer A pointer to the buffer to write the random data to.
  * @param count The number of bytes to read. Must be less than or equal to the
  * size of the buffer.
- * @return The number of bytes read.
+ * @return The number of bytes read, less than `count` only if the device
+ * failed. Reads interrupted by a signal are resumed.
  */
 size_t random_device_read(random_device_t *instance, void *buffer,
                           size_t count);
@@ -90,6 +91,8 @@ typedef struct RandomEngine {
 typedef random_engine_t *(*random_engine_ctor_fn)(void);
 typedef uint64_t (*random_engine_next_fn)(random_engine_t *instance);
 typedef void (*random_engine_data_dtor_fn)(random_engine_t *instance);
+typedef void (*random_engine_fill_fn)(random_engine_t *instance,
+                                      uint64_t *out, size_t n);
 
 /**
  * @brief Random engine specification structure.
@@ -105,6 +108,9 @@ typedef void (*random_engine_data_dtor_fn)(random_engine_t *instance);
       next; ///< Function to generate the next random number in the engine.
   random_engine_data_dtor_fn dtor; ///< Function to release the memory allocated
                                    ///< for data by the random engine.
+  random_engine_fill_fn fill; ///< Optional function to generate many random
+                              ///< numbers at once, NULL to call `next` in a
+                              ///< loop instead.
 };
 
 typedef const struct RandomEngineSpec * random_engine_spec_t;
@@ -129,6 +135,18 @@ random_engine_t * random_engine_ctor(random_engine_spec_t spec, void *data);
  */
 uint64_t random_engine_next(random_engine_t *instance);
 
+/**
+ * @brief Fill an array with random numbers from the random engine.
+ *
+ * @note The numbers are the same as those returned by `n` calls to
+ * `random_engine_next`, but the engine is only dispatched once.
+ *
+ * @param instance A pointer to the random engine instance.
+ * @param out A pointer to the array to fill.
+ * @param n The number of random numbers to generate.
+ */
+void random_engine_fill(random_engine_t *instance, uint64_t *out, size_t n);
+
 /**
  * @brief Free memory used by the random engine.
  *
@@ -162,15 +180,37 @@ void *random_engine_data(random_engine_t *engine);
 
 extern const struct RandomEngineSpec RandomDeviceEngine;
 
+/**
+ * @brief Random device engine serving numbers from blocks of random bytes,
+ * read at once with getrandom(2) where available.
+ *
+ * @note Use `random_device_buffered_engine_ctor_size` from `random_device.h`
+ * to choose the size of the blocks.
+ */
+extern const struct RandomEngineSpec RandomDeviceBufferedEngine;
+
+/**
+ * @brief Engine running 8 xoshiro256** streams in parallel vector lanes, for
+ * bulk sampling through `random_engine_fill`.
+ *
+ * @note Use `xoshiro256ss_lanes_engine_ctor_seed` from `xoshiro256ss_lanes.h`
+ * for a seeded engine, and the lane-indexed API of the same header to draw
+ * each stream separately.
+ */
+extern const struct RandomEngineSpec Xoshiro256ssLanesEngine;
+
 typedef random_engine_t * (*xoshiro256ss_ctor_full_fn)(const uint64_t seed[4]);
 typedef random_engine_t * (*xoshiro256ss_ctor_seed_fn)(uint64_t seed);
 typedef random_engine_t * (*xoshiro256ss_ctor_rd_fn)(random_device_t *rd);
+typedef void (*xoshiro256ss_jump_fn)(random_engine_t *engine);
+typedef bool (*xoshiro256ss_fork_fn)(random_engine_t *engine,
+                                     random_engine_t **children, size_t n);
 
 /**
  * @brief Specification for the Xoshiro256** random engine.
  *
  * @note
- * The first 4 fields is inherited from the [RandomEngineSpec](RandomEngineSpec.md) structure.
+ * The first 5 fields is inherited from the [RandomEngineSpec](RandomEngineSpec.md) structure.
  * So this structure can be cast and used as a [RandomEngineSpec](RandomEngineSpec.md).
  *
  */
@@ -179,9 +219,13 @@ struct Xoshiro256ssSpec {
   random_engine_ctor_fn ctor; ///< Constructor function to create an instance of Xoshiro256ss. [xoshiro256ss_ctor](../xoshiro256ss/#xoshiro256ss_ctor)
   random_engine_next_fn next; ///< Function to generate the next random number in the engine. [xoshiro256ss_next](../xoshiro256ss/#xoshiro256ss_next)
   random_engine_data_dtor_fn dtor; ///< Function to release the memory allocated for data by Xoshiro256ss. [xoshiro256ss_dtor](../xoshiro256ss/#xoshiro256ss_dtor)
+  random_engine_fill_fn fill; ///< Function to generate many random numbers at once. [xoshiro256ss_fill](../xoshiro256ss/#xoshiro256ss_fill)
   xoshiro256ss_ctor_full_fn ctor_full; ///< Constructor function with a full 256-bit seed. [xoshiro256ss_ctor_full](../xoshiro256ss/#xoshiro256ss_ctor_full)
   xoshiro256ss_ctor_seed_fn ctor_seed; ///< Constructor function with a single 64-bit seed. [xoshiro256ss_ctor_seed](../xoshiro256ss/#xoshiro256ss_ctor_seed)
   xoshiro256ss_ctor_rd_fn ctor_rd; ///< Constructor function with a random device. [xoshiro256ss_ctor_rd](../xoshiro256ss/#xoshiro256ss_ctor_rd)
+  xoshiro256ss_jump_fn jump; ///< Function to advance the engine by 2^128 numbers. [xoshiro256ss_jump](../xoshiro256ss/#xoshiro256ss_jump)
+  xoshiro256ss_jump_fn long_jump; ///< Function to advance the engine by 2^192 numbers. [xoshiro256ss_long_jump](../xoshiro256ss/#xoshiro256ss_long_jump)
+  xoshiro256ss_fork_fn fork; ///< Function to construct engines drawing non-overlapping streams. [xoshiro256ss_fork](../xoshiro256ss/#xoshiro256ss_fork)
 };
 
 extern const struct Xoshiro256ssSpec Xoshiro256ssEngine;
@@ -225,9 +269,93 @@ double uniform_real_distribution(random_engine_t *engine, double min,
  */
 bool bernoulli_distribution(random_engine_t *engine, double probability);
 
+/**
+ * @brief Multiply two 64-bit integers into a 128-bit product.
+ *
+ * @param a The first factor.
+ * @param b The second factor.
+ * @param lo Receives the low 64 bits of the product.
+ * @return The high 64 bits of the product.
+ *
+ * @ingroup distributions
+ */
+static inline uint64_t random_mul128(uint64_t a, uint64_t b, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = (__uint128_t)a * b;
+  *lo = (uint64_t)product;
+  return (uint64_t)(product >> 64);
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi;
+  uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+  *lo = (cross << 32) | (uint32_t)lo_lo;
+  return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+/**
+ * @brief Generate a random integer uniformly distributed in the range `[0,
+ * range)`, without modulo bias.
+ *
+ * @note Uses Lemire's multiply-shift method: the range is scaled by a 64-bit
+ * number instead of divided into it, and the rare draws that would bias the
+ * result are rejected. A division only happens on the first draw in the
+ * biased region, with a probability below `range / 2^64`.
+ *
+ * @param engine A pointer to the random engine.
+ * @param range The number of possible values (must be > 0).
+ * @return A random integer in the range `[0, range)`.
+ *
+ * @ingroup distributions
+ */
+uint64_t bounded_int_distribution(random_engine_t *engine, uint64_t range);
+
+/**
+ * @brief Convert a probability into a threshold for
+ * `bernoulli_threshold_distribution`.
+ *
+ * @note The threshold is `probability * 2^64`, saturated to `UINT64_MAX`: a
+ * probability of 1.0 then succeeds with a probability of `1 - 2^-64`.
+ *
+ * @param probability The probability of success (between 0.0 and 1.0).
+ * @return The threshold of the probability.
+ *
+ * @ingroup distributions
+ */
+static inline uint64_t bernoulli_threshold(double probability) {
+  if (!(probability > 0.0)) {
+    return 0;
+  }
+  if (probability >= 1.0) {
+    return UINT64_MAX;
+  }
+  // Scaling by a power of two is exact, the product is below 2^64
+  return (uint64_t)(probability * 18446744073709551616.0);
+}
+
+/**
+ * @brief Generate a random boolean value with a precomputed probability,
+ * without any floating-point operation.
+ *
+ * @param engine A pointer to the random engine.
+ * @param threshold The threshold of the probability, from
+ * `bernoulli_threshold`.
+ * @return A random boolean value, `true` with a probability of `threshold /
+ * 2^64`.
+ *
+ * @ingroup distributions
+ */
+bool bernoulli_threshold_distribution(random_engine_t *engine,
+                                      uint64_t threshold);
+
 /**
  * @brief Generate a random value from a binomial distribution.
  *
+ * @note Small means, up to 30 for the rarer outcome, are sampled by
+ * sequential search. Larger ones use the BTPE algorithm of Kachitvichyanukul
+ * and Schmeiser, whose cost does not grow with `n`.
+ *
  * @param engine A pointer to the random engine.
  * @param n The number of trials (must be >= 0).
  * @param p The probability of success in a single trial (range: [0.0, 1.0]).
@@ -241,6 +369,10 @@ uint64_t binomial_distribution(random_engine_t *engine, uint64_t n, double p);
 /**
  * @brief Generate a random value from a Poisson distribution.
  *
+ * @note Means below 10 are sampled with Knuth's multiplication method. Larger
+ * ones use the PTRS algorithm of Hörmann, whose cost does not grow with
+ * `lambda` and which does not underflow.
+ *
  * @param engine A pointer to the random engine.
  * @param lambda The mean of the Poisson distribution (must be > 0).
  * @return A random value representing the number of events in the range [0, ∞).
@@ -276,4 +408,60 @@ double normal_distribution(random_engine_t *engine, double mu, double sigma);
 size_t discrete_distribution(random_engine_t *engine, const double *weights,
                              size_t size);
 
+/**
+ * @brief Alias table type, samples a discrete distribution in constant time.
+ *
+ * @note Built once with `alias_table_ctor`, then sampled any number of times
+ * with `alias_table_sample` instead of `discrete_distribution`.
+ */
+typedef struct AliasTable alias_table_t;
+
+/**
+ * @brief Construct an alias table for the given weights, with Vose's method.
+ *
+ * @param weights An array of non-negative weights for each index, not
+ * necessarily summing to 1. Indices of weight 0 are never sampled.
+ * @param size The number of elements in the weights array.
+ * @return A pointer to the alias table, NULL if `size` is 0, if a weight is
+ * negative or not a number, if the weights sum to 0 or to infinity, or if the
+ * table could not be allocated.
+ *
+ * @ingroup distributions
+ */
+alias_table_t *alias_table_ctor(const double *weights, size_t size);
+
+/**
+ * @brief Generate a random index from an alias table, in constant time.
+ *
+ * @note Draws two numbers from the engine: one to pick a column, one to
+ * choose between the column and its alias.
+ *
+ * @param table A pointer to the alias table.
+ * @param engine A pointer to the random engine.
+ * @return A random index in the range [0, size-1], sampled according to the
+ * weights of the table.
+ *
+ * @ingroup distributions
+ */
+size_t alias_table_sample(const alias_table_t *table, random_engine_t *engine);
+
+/**
+ * @brief Get the number of indices of an alias table.
+ *
+ * @param table A pointer to the alias table.
+ * @return The number of weights the table was built from.
+ *
+ * @ingroup distributions
+ */
+size_t alias_table_size(const alias_table_t *table);
+
+/**
+ * @brief Free memory used by the alias table.
+ *
+ * @param table A pointer to the alias table.
+ *
+ * @ingroup distributions
+ */
+void alias_table_dtor(alias_table_t *table);
+
 #endif
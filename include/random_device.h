@@ -6,6 +6,38 @@
 
 random_engine_t *random_device_engine_ctor(void);
 uint64_t random_device_engine_next(random_engine_t *engine);
+void random_device_engine_fill(random_engine_t *engine, uint64_t *out,
+                               size_t n);
 void random_device_engine_dtor(random_engine_t *engine);
 
+/**
+ * @brief Default size of the block read at once by the buffered random device
+ * engine, in bytes.
+ */
+#define RANDOM_DEVICE_BUFFERED_ENGINE_BLOCK_SIZE 4096
+
+/**
+ * @brief Construct a random device engine reading random bytes by blocks.
+ *
+ * @note Blocks are read with getrandom(2) where available, from the default
+ * random device otherwise. The process exits if random bytes cannot be read,
+ * rather than serving predictable numbers.
+ *
+ * @param size The size of a block in bytes, rounded down to a multiple of 8.
+ * @return A pointer to the random engine instance.
+ */
+random_engine_t *random_device_buffered_engine_ctor_size(size_t size);
+
+/**
+ * @brief Construct a buffered random device engine with blocks of
+ * `RANDOM_DEVICE_BUFFERED_ENGINE_BLOCK_SIZE` bytes.
+ *
+ * @return A pointer to the random engine instance.
+ */
+random_engine_t *random_device_buffered_engine_ctor(void);
+uint64_t random_device_buffered_engine_next(random_engine_t *engine);
+void random_device_buffered_engine_fill(random_engine_t *engine, uint64_t *out,
+                                        size_t n);
+void random_device_buffered_engine_dtor(random_engine_t *engine);
+
 #endif /* H_RANDOM_DEVICE_INCLUDED */
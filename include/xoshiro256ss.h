@@ -2,8 +2,24 @@
 #ifndef H_XOSHIRO256SS_INCLUDED
 #define H_XOSHIRO256SS_INCLUDED
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include "random.h"
 
+/**
+* @brief State of a xoshiro256** random number generator, as a plain value.
+*
+* @note Unlike the engines built by the constructors below, a state needs no
+* allocation: it can live on the stack or be embedded in another structure,
+* and the inline functions of this header draw from it without any dispatch.
+*
+* @ingroup xoshiro256ss
+*/
+typedef struct Xoshiro256ss {
+  uint64_t state[4];
+} xoshiro256ss_t;
+
 /**
 * @brief Construct a new xoshiro256** random number generator with a full 256-bit seed.
 *
@@ -26,6 +42,161 @@ random_engine_t *xoshiro256ss_ctor_full(const uint64_t seed[4]);
 */
 random_engine_t *xoshiro256ss_ctor_seed(const uint64_t seed);
 
+/**
+* @brief Generate the next number of a splitmix64 sequence.
+*
+* @note Used to expand a 64-bit seed into the 256-bit state of xoshiro256**,
+* consecutive outputs are well decorrelated even for close seeds.
+*
+* @param state The splitmix64 state, advanced by the call.
+* @return uint64_t The next number.
+*
+* @ingroup xoshiro256ss
+*/
+static inline uint64_t splitmix64_next(uint64_t *state) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/**
+* @brief Seed a xoshiro256** state with a 64-bit seed.
+*
+* @note The seed is expanded like `xoshiro256ss_ctor_seed` does, so the state
+* draws the same numbers as an engine constructed with the same seed.
+*
+* @param rng The state to seed.
+* @param seed The 64-bit seed.
+*
+* @ingroup xoshiro256ss
+*/
+static inline void xoshiro256ss_seed(xoshiro256ss_t *rng, uint64_t seed) {
+  for (int i = 0; i < 4; ++i) {
+    rng->state[i] = splitmix64_next(&seed);
+  }
+}
+
+/**
+* @brief Seed a xoshiro256** state with a random seed read from the given random device.
+*
+* @param rng The state to seed.
+* @param rd The random device.
+* @return bool false if the device could not be read, the state is unchanged then.
+*
+* @ingroup xoshiro256ss
+*/
+bool xoshiro256ss_seed_rd(xoshiro256ss_t *rng, random_device_t *rd);
+
+/**
+* @brief Generate the next random number from a xoshiro256** state.
+*
+* @note Draws the same numbers as `xoshiro256ss_next` on an engine in the same
+* state, but can be inlined in the caller.
+*
+* @param rng The state, advanced by the call.
+* @return uint64_t The next random number.
+*
+* @ingroup xoshiro256ss
+*/
+static inline uint64_t xoshiro256ss_step(xoshiro256ss_t *rng) {
+  uint64_t *s = rng->state;
+  uint64_t x = s[1] * 5;
+  uint64_t result = ((x << 7) | (x >> 57)) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = (s[3] << 45) | (s[3] >> 19);
+  return result;
+}
+
+/**
+* @brief Generate a random integer uniformly distributed in the range `[min, max]` from a xoshiro256** state.
+*
+* @note Same result as `uniform_int_distribution` on an engine in the same state.
+*
+* @param rng The state, advanced by the call.
+* @param min The minimum value (inclusive).
+* @param max The maximum value (inclusive).
+* @return int A random integer in the specified range.
+*
+* @ingroup xoshiro256ss
+*/
+static inline int xoshiro256ss_uniform_int(xoshiro256ss_t *rng, int min,
+                                           int max) {
+  return min + (int)(xoshiro256ss_step(rng) % (uint64_t)(max - min + 1));
+}
+
+/**
+* @brief Generate a random boolean value based on the given probability from a xoshiro256** state.
+*
+* @note Same result as `bernoulli_distribution` on an engine in the same state.
+*
+* @param rng The state, advanced by the call.
+* @param probability The probability of returning `true` (between 0.0 and 1.0).
+* @return bool A random boolean value (`true` with the specified probability).
+*
+* @ingroup xoshiro256ss
+*/
+static inline bool xoshiro256ss_bernoulli(xoshiro256ss_t *rng,
+                                          double probability) {
+  return xoshiro256ss_step(rng) / (double)UINT64_MAX < probability;
+}
+
+/**
+* @brief Generate a random integer uniformly distributed in the range `[0, range)` from a xoshiro256** state, without modulo bias.
+*
+* @note Same result as `bounded_int_distribution` on an engine in the same state.
+*
+* @param rng The state, advanced by the call.
+* @param range The number of possible values (must be > 0).
+* @return uint64_t A random integer in the range `[0, range)`.
+*
+* @ingroup xoshiro256ss
+*/
+static inline uint64_t xoshiro256ss_bounded(xoshiro256ss_t *rng,
+                                            uint64_t range) {
+  uint64_t lo;
+  uint64_t hi = random_mul128(xoshiro256ss_step(rng), range, &lo);
+  if (lo < range) {
+    uint64_t threshold = (UINT64_MAX - range + 1) % range;
+    while (lo < threshold) {
+      hi = random_mul128(xoshiro256ss_step(rng), range, &lo);
+    }
+  }
+  return hi;
+}
+
+/**
+* @brief Generate a random boolean value with a precomputed probability from a xoshiro256** state.
+*
+* @note Same result as `bernoulli_threshold_distribution` on an engine in the same state.
+*
+* @param rng The state, advanced by the call.
+* @param threshold The threshold of the probability, from `bernoulli_threshold`.
+* @return bool A random boolean value, `true` with a probability of `threshold / 2^64`.
+*
+* @ingroup xoshiro256ss
+*/
+static inline bool xoshiro256ss_bernoulli_threshold(xoshiro256ss_t *rng,
+                                                    uint64_t threshold) {
+  return xoshiro256ss_step(rng) < threshold;
+}
+
+/**
+* @brief Advance a xoshiro256** state by 2^128 numbers.
+*
+* @note Same as `xoshiro256ss_jump` on an engine in the same state.
+*
+* @param rng The state to advance.
+*
+* @ingroup xoshiro256ss
+*/
+void xoshiro256ss_jump_state(xoshiro256ss_t *rng);
+
 /**
 * @brief Construct a new xoshiro256** random number generator with a random seed generated from the given random device.
 *
@@ -55,6 +226,60 @@ random_engine_t *xoshiro256ss_ctor(void);
 */
 uint64_t xoshiro256ss_next(random_engine_t *engine);
 
+/**
+* @brief Fill an array with the next random numbers from the xoshiro256** random number generator.
+*
+* @param engine The random number generator.
+* @param out The array to fill.
+* @param n The number of random numbers to generate.
+*
+* @ingroup xoshiro256ss
+*/
+void xoshiro256ss_fill(random_engine_t *engine, uint64_t *out, size_t n);
+
+/**
+* @brief Advance the xoshiro256** random number generator by 2^128 numbers.
+*
+* @note Used to generate 2^128 non-overlapping subsequences for parallel
+* computations.
+*
+* @param engine The random number generator.
+*
+* @ingroup xoshiro256ss
+*/
+void xoshiro256ss_jump(random_engine_t *engine);
+
+/**
+* @brief Advance the xoshiro256** random number generator by 2^192 numbers.
+*
+* @note Used to generate 2^64 starting points, from each of which
+* `xoshiro256ss_jump` generates 2^64 non-overlapping subsequences.
+*
+* @param engine The random number generator.
+*
+* @ingroup xoshiro256ss
+*/
+void xoshiro256ss_long_jump(random_engine_t *engine);
+
+/**
+* @brief Construct `n` xoshiro256** random number generators drawing non-overlapping streams.
+*
+* @note Child `i` starts where the engine stood after `i` jumps, the engine
+* itself is left `n` jumps ahead, past every child stream. Forking the same
+* seeded engine always gives the same children.
+*
+* @param engine The random number generator to fork.
+* @param children The array receiving the `n` children, to be released with
+* `random_engine_dtor`.
+* @param n The number of children.
+* @return bool false if a child could not be allocated, no child is left
+* allocated then.
+*
+* @ingroup xoshiro256ss
+*/
+bool xoshiro256ss_fork(random_engine_t *engine, random_engine_t **children,
+                       size_t n);
+
 /**
 * @brief Release the resources used by the xoshiro256** random number generator.
 *
@@ -0,0 +1,150 @@
+#pragma once
+#ifndef H_XOSHIRO256SS_LANES_INCLUDED
+#define H_XOSHIRO256SS_LANES_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "random.h"
+#include "xoshiro256ss.h"
+
+/**
+* @brief Number of independent xoshiro256** streams run side by side.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+#define XOSHIRO256SS_LANES 8
+
+/**
+* @brief States of `XOSHIRO256SS_LANES` xoshiro256** random number generators, stepped together.
+*
+* @note The states are stored word by word, `state[w][lane]`, so that a
+* vector register holds the same word of several lanes. Every lane draws
+* exactly the numbers of a scalar xoshiro256** in the same state.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+typedef struct Xoshiro256ssLanes {
+  uint64_t state[4][XOSHIRO256SS_LANES];
+} xoshiro256ss_lanes_t;
+
+/**
+* @brief Function stepping every lane `n_steps` times.
+*
+* @param lanes The states, advanced by the call.
+* @param out The array receiving `n_steps * XOSHIRO256SS_LANES` numbers, the
+* number of step `s` of lane `l` at `out[s * XOSHIRO256SS_LANES + l]`.
+* @param n_steps The number of steps.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+typedef void (*xoshiro256ss_lanes_fill_fn)(xoshiro256ss_lanes_t *lanes,
+                                           uint64_t *out, size_t n_steps);
+
+/**
+* @brief Implementation of `xoshiro256ss_lanes_fill` for an instruction set.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+typedef struct Xoshiro256ssLanesKernel {
+  const char *name;              ///< Name of the instruction set
+  bool (*supported)(void);       ///< Whether the running CPU can use the kernel
+  xoshiro256ss_lanes_fill_fn fill; ///< Kernel stepping every lane
+} xoshiro256ss_lanes_kernel_t;
+
+/// Portable kernel, one lane at a time
+extern const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesScalar;
+/// x86 kernel using AVX2, 4 lanes per register, unsupported on other architectures
+extern const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx2;
+/// x86 kernel using AVX-512, 8 lanes per register, unsupported on other architectures
+extern const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx512;
+
+/**
+* @brief Get the fastest kernel supported by the running CPU, selected on first call.
+*
+* @return const xoshiro256ss_lanes_kernel_t* The kernel, `Xoshiro256ssLanesScalar` if no vector kernel is supported.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+const xoshiro256ss_lanes_kernel_t *xoshiro256ss_lanes_kernel(void);
+
+/**
+* @brief Seed every lane from a 64-bit seed, with non-overlapping streams.
+*
+* @note Lane 0 draws the numbers of `xoshiro256ss_ctor_seed(seed)`, lane `l`
+* those of the same engine after `l` jumps, like the children of
+* `xoshiro256ss_fork`.
+*
+* @param lanes The states to seed.
+* @param seed The 64-bit seed.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+void xoshiro256ss_lanes_seed(xoshiro256ss_lanes_t *lanes, uint64_t seed);
+
+/**
+* @brief Set the state of a lane.
+*
+* @param lanes The states.
+* @param lane The index of the lane, below `XOSHIRO256SS_LANES`.
+* @param rng The state given to the lane.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+void xoshiro256ss_lanes_set(xoshiro256ss_lanes_t *lanes, size_t lane,
+                            const xoshiro256ss_t *rng);
+
+/**
+* @brief Get the state of a lane.
+*
+* @param lanes The states.
+* @param lane The index of the lane, below `XOSHIRO256SS_LANES`.
+* @param rng Receives the state of the lane.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+void xoshiro256ss_lanes_get(const xoshiro256ss_lanes_t *lanes, size_t lane,
+                            xoshiro256ss_t *rng);
+
+/**
+* @brief Step every lane `n_steps` times with the fastest supported kernel.
+*
+* @param lanes The states, advanced by the call.
+* @param out The array receiving `n_steps * XOSHIRO256SS_LANES` numbers, the
+* number of step `s` of lane `l` at `out[s * XOSHIRO256SS_LANES + l]`.
+* @param n_steps The number of steps.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+void xoshiro256ss_lanes_fill(xoshiro256ss_lanes_t *lanes, uint64_t *out,
+                             size_t n_steps);
+
+/**
+* @brief Construct a random engine serving the numbers of the lanes, seeded from a 64-bit seed.
+*
+* @note The engine serves the numbers of every lane in turn, step after step,
+* in the order of `xoshiro256ss_lanes_fill`. `random_engine_fill` writes whole
+* steps straight into its output.
+*
+* @param seed The 64-bit seed, given to `xoshiro256ss_lanes_seed`.
+* @return random_engine_t* The constructed random number generator.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+random_engine_t *xoshiro256ss_lanes_engine_ctor_seed(uint64_t seed);
+
+/**
+* @brief Construct a random engine serving the numbers of the lanes, seeded from the default random device.
+*
+* @return random_engine_t* The constructed random number generator.
+*
+* @ingroup xoshiro256ss_lanes
+*/
+random_engine_t *xoshiro256ss_lanes_engine_ctor(void);
+uint64_t xoshiro256ss_lanes_engine_next(random_engine_t *engine);
+void xoshiro256ss_lanes_engine_fill(random_engine_t *engine, uint64_t *out,
+                                    size_t n);
+void xoshiro256ss_lanes_engine_dtor(random_engine_t *engine);
+
+#endif /* H_XOSHIRO256SS_LANES_INCLUDED */
@@ -0,0 +1,225 @@
+#include "core/ai.h"
+#include "core/bitboard.h"
+#include "core/transposition.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define LINE_COUNT 65536
+#define TABLE_BITS 18
+
+// Zobrist key of "player to move", keeps the max node entries (boards after a
+// spawn) apart from the chance node entries (boards after a move)
+#define MAX_NODE_KEY 0xD6E8FEB86659FD93ULL
+
+static const AiHeuristic DEFAULT_HEURISTICS[] = {
+    {AiHeuristicAlive, 200000.0},  {AiHeuristicEmpty, 270.0},
+    {AiHeuristicMerges, 700.0},    {AiHeuristicMonotonicity, 47.0},
+    {AiHeuristicSum, 11.0},
+};
+
+double AiHeuristicAlive(const uint8_t line[BITBOARD_SIZE]) {
+  (void)line;
+  return 1.0;
+}
+
+double AiHeuristicEmpty(const uint8_t line[BITBOARD_SIZE]) {
+  double empty = 0;
+  for (uint8_t x = 0; x < BITBOARD_SIZE; ++x) {
+    empty += line[x] == 0;
+  }
+  return empty;
+}
+
+double AiHeuristicMerges(const uint8_t line[BITBOARD_SIZE]) {
+  double merges = 0;
+  uint8_t previous = 0, counter = 0;
+  for (uint8_t x = 0; x < BITBOARD_SIZE; ++x) {
+    if (line[x] == 0) {
+      continue;
+    }
+    if (line[x] == previous) {
+      ++counter;
+    } else if (counter > 0) {
+      merges += 1 + counter;
+      counter = 0;
+    }
+    previous = line[x];
+  }
+  if (counter > 0) {
+    merges += 1 + counter;
+  }
+  return merges;
+}
+
+double AiHeuristicMonotonicity(const uint8_t line[BITBOARD_SIZE]) {
+  double left = 0, right = 0;
+  for (uint8_t x = 1; x < BITBOARD_SIZE; ++x) {
+    double a = pow(line[x - 1], 4), b = pow(line[x], 4);
+    if (line[x - 1] > line[x]) {
+      left += a - b;
+    } else {
+      right += b - a;
+    }
+  }
+  return -(left < right ? left : right);
+}
+
+double AiHeuristicSum(const uint8_t line[BITBOARD_SIZE]) {
+  double sum = 0;
+  for (uint8_t x = 0; x < BITBOARD_SIZE; ++x) {
+    sum += pow(line[x], 3.5);
+  }
+  return -sum;
+}
+
+AiConfig AiDefaultConfig(void) {
+  AiConfig config = {
+      .depth = 3,
+      .probability_cutoff = 0.0001,
+      .heuristics = DEFAULT_HEURISTICS,
+      .n_heuristics = sizeof(DEFAULT_HEURISTICS) / sizeof(DEFAULT_HEURISTICS[0]),
+      .table = NULL,
+  };
+  return config;
+}
+
+void AiSolverInit(AiSolver *solver, const AiConfig *config) {
+  BitboardInit();
+  *solver = (AiSolver)malloc(sizeof(struct AiSolver));
+  (*solver)->config = *config;
+  (*solver)->lineScores = (float *)malloc(LINE_COUNT * sizeof(float));
+  (*solver)->ownsTable = config->table == NULL;
+  if ((*solver)->ownsTable) {
+    TranspositionInit(&(*solver)->table, TABLE_BITS);
+  } else {
+    (*solver)->table = config->table;
+  }
+  for (uint32_t row = 0; row < LINE_COUNT; ++row) {
+    uint8_t line[BITBOARD_SIZE];
+    for (uint8_t x = 0; x < BITBOARD_SIZE; ++x) {
+      line[x] = (row >> (4 * x)) & 0xF;
+    }
+    double score = 0;
+    for (uint8_t i = 0; i < config->n_heuristics; ++i) {
+      score += config->heuristics[i].weight *
+               config->heuristics[i].evaluate(line);
+    }
+    (*solver)->lineScores[row] = (float)score;
+  }
+}
+
+static inline double ScoreRows(AiSolver solver, Bitboard board) {
+  return solver->lineScores[board & 0xFFFF] +
+         solver->lineScores[(board >> 16) & 0xFFFF] +
+         solver->lineScores[(board >> 32) & 0xFFFF] +
+         solver->lineScores[(board >> 48) & 0xFFFF];
+}
+
+static inline double ScoreBoard(AiSolver solver, Bitboard board) {
+  return ScoreRows(solver, board) +
+         ScoreRows(solver, BitboardTranspose(board));
+}
+
+static double ChanceNode(AiSolver solver, Bitboard board, uint8_t depth,
+                         double probability);
+
+// Best expected score over the player moves, 0 when the game is lost
+static double MaxNode(AiSolver solver, Bitboard board, uint8_t depth,
+                      double probability) {
+  double best = 0;
+  for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+    Bitboard moved = board;
+    if (BitboardMove(&moved, direction, NULL)) {
+      double score = ChanceNode(solver, moved, depth, probability);
+      if (score > best) {
+        best = score;
+      }
+    }
+  }
+  return best;
+}
+
+// Expected score over the tile spawns, weighted like GameAddRandomTile
+static double ChanceNode(AiSolver solver, Bitboard board, uint8_t depth,
+                         double probability) {
+  if (depth == 0 || probability < solver->config.probability_cutoff) {
+    return ScoreBoard(solver, board);
+  }
+  // Different move orders reach the same boards, reuse their score
+  uint64_t hash = TranspositionHashBitboard(board);
+  TranspositionEntry entry;
+  if (TranspositionProbe(solver->table, hash, depth, &entry)) {
+    return entry.value;
+  }
+  uint8_t n_empty = BitboardCountEmpty(board);
+  probability /= n_empty;
+
+  double score = 0;
+  for (uint8_t index = 0; index < BITBOARD_SIZE * BITBOARD_SIZE; ++index) {
+    if (BitboardGetCell(board, index)) {
+      continue;
+    }
+    Bitboard two = board | (Bitboard)1 << (4 * index);
+    Bitboard four = board | (Bitboard)2 << (4 * index);
+    score += 0.9 * MaxNode(solver, two, depth - 1, probability * 0.9);
+    score += 0.1 * MaxNode(solver, four, depth - 1, probability * 0.1);
+  }
+  score /= n_empty;
+  entry.value = (float)score;
+  entry.depth = depth;
+  entry.move = TRANSPOSITION_NO_MOVE;
+  TranspositionStore(solver->table, hash, &entry);
+  return score;
+}
+
+bool AiSolverBestMoveBitboard(AiSolver solver, Bitboard board,
+                              Direction *direction) {
+  bool found = false;
+  double best = 0;
+  uint8_t depth = solver->config.depth ? solver->config.depth - 1 : 0;
+  uint64_t hash = TranspositionHashBitboard(board) ^ MAX_NODE_KEY;
+  TranspositionEntry entry;
+  if (TranspositionProbe(solver->table, hash, solver->config.depth, &entry) &&
+      entry.move != TRANSPOSITION_NO_MOVE) {
+    *direction = entry.move;
+    return true;
+  }
+  TranspositionNewSearch(solver->table);
+  for (Direction candidate = LEFT; candidate <= DOWN; ++candidate) {
+    Bitboard moved = board;
+    if (!BitboardMove(&moved, candidate, NULL)) {
+      continue;
+    }
+    double score = ChanceNode(solver, moved, depth, 1.0);
+    if (!found || score > best) {
+      best = score;
+      *direction = candidate;
+      found = true;
+    }
+  }
+  if (found) {
+    entry.value = (float)best;
+    entry.depth = solver->config.depth;
+    entry.move = *direction;
+    TranspositionStore(solver->table, hash, &entry);
+  }
+  return found;
+}
+
+bool AiSolverBestMove(AiSolver solver, Game game, Direction *direction) {
+  Bitboard board;
+  if (!BitboardFromGrid(game->grid, &board)) {
+    return false;
+  }
+  return AiSolverBestMoveBitboard(solver, board, direction);
+}
+
+void AiSolverFree(AiSolver *solver) {
+  if ((*solver)->ownsTable) {
+    TranspositionFree(&(*solver)->table);
+  }
+  free((*solver)->lineScores);
+  free(*solver);
+  *solver = NULL;
+}
@@ -0,0 +1,46 @@
+#include "core/arena.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Round `n` up to a multiple of `ARENA_ALIGNMENT`
+#define ALIGN_UP(n) (((n) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+
+bool ArenaInit(Arena *arena, size_t capacity) {
+  *arena = malloc(sizeof(struct Arena));
+  if (!*arena) {
+    return false;
+  }
+  // Blocks are padded to the alignment, so is the capacity
+  (*arena)->capacity = ALIGN_UP(capacity);
+  (*arena)->base = malloc((*arena)->capacity);
+  if (!(*arena)->base) {
+    free(*arena);
+    *arena = NULL;
+    return false;
+  }
+  (*arena)->used = 0;
+  return true;
+}
+
+void *ArenaAlloc(Arena arena, size_t bytes) {
+  size_t padded = ALIGN_UP(bytes);
+  if (padded < bytes || padded > arena->capacity - arena->used) {
+    return NULL;
+  }
+  void *block = arena->base + arena->used;
+  arena->used += padded;
+  return block;
+}
+
+void ArenaRewind(Arena arena, size_t mark) {
+  if (mark < arena->used) {
+    arena->used = mark;
+  }
+}
+
+void ArenaFree(Arena *arena) {
+  free((*arena)->base);
+  free(*arena);
+  *arena = NULL;
+}
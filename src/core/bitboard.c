@@ -0,0 +1,181 @@
+#include "core/bitboard.h"
+#include "random.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ROW_COUNT 65536
+#define ROW_MASK 0xFFFFULL
+
+static uint16_t rowLeft[ROW_COUNT];
+static uint16_t rowRight[ROW_COUNT];
+static uint32_t rowScore[ROW_COUNT];
+static bool initialized = false;
+
+static inline uint16_t ReverseRow(uint16_t row) {
+  return (row >> 12) | ((row >> 4) & 0x00F0) | ((row << 4) & 0x0F00) |
+         (row << 12);
+}
+
+// Slide and merge a single row towards nibble 0, the way `GameMove` does it
+// for one line: merge every tile with the previous unmerged one, then compact
+static void BuildRow(uint16_t row) {
+  uint8_t line[BITBOARD_SIZE];
+  uint8_t out[BITBOARD_SIZE] = {0};
+  uint32_t score = 0;
+  uint8_t x, n = 0;
+  bool mergeable = false;
+  for (x = 0; x < BITBOARD_SIZE; ++x) {
+    line[x] = (row >> (4 * x)) & 0xF;
+  }
+  for (x = 0; x < BITBOARD_SIZE; ++x) {
+    if (line[x] == 0) {
+      continue;
+    }
+    if (mergeable && out[n - 1] == line[x] &&
+        line[x] < BITBOARD_MAX_EXPONENT) {
+      ++out[n - 1];
+      score += 1u << out[n - 1];
+      mergeable = false;
+    } else {
+      out[n++] = line[x];
+      mergeable = true;
+    }
+  }
+  uint16_t result = 0;
+  for (x = 0; x < BITBOARD_SIZE; ++x) {
+    result |= (uint16_t)out[x] << (4 * x);
+  }
+  uint16_t reversed = ReverseRow(row);
+  rowLeft[row] = result;
+  rowRight[reversed] = ReverseRow(result);
+  rowScore[row] = score;
+}
+
+void BitboardInit(void) {
+  if (initialized) {
+    return;
+  }
+  for (uint32_t row = 0; row < ROW_COUNT; ++row) {
+    BuildRow(row);
+  }
+  initialized = true;
+}
+
+bool BitboardFromGrid(Grid grid, Bitboard *board) {
+  if (grid->size != BITBOARD_SIZE) {
+    return false;
+  }
+  Bitboard result = 0;
+  for (uint8_t i = 0; i < grid->length; ++i) {
+    uint64_t value = grid->cells[i];
+    if (value == 0) {
+      continue;
+    }
+    uint64_t exponent = __builtin_ctzll(value);
+    if (exponent > BITBOARD_MAX_EXPONENT) {
+      return false;
+    }
+    result |= exponent << (4 * i);
+  }
+  *board = result;
+  return true;
+}
+
+void BitboardToGrid(Bitboard board, Grid grid) {
+  for (uint8_t i = 0; i < grid->length; ++i) {
+    uint8_t exponent = BitboardGetCell(board, i);
+    grid->cells[i] = exponent ? (uint64_t)1 << exponent : 0;
+  }
+  GridSync(grid);
+}
+
+static inline Bitboard MoveRows(Bitboard board, const uint16_t *table,
+                                uint64_t *score) {
+  Bitboard result = 0;
+  for (uint8_t y = 0; y < BITBOARD_SIZE; ++y) {
+    uint16_t row = (board >> (16 * y)) & ROW_MASK;
+    result |= (Bitboard)table[row] << (16 * y);
+    *score += rowScore[row];
+  }
+  return result;
+}
+
+bool BitboardMove(Bitboard *board, Direction direction, uint64_t *score) {
+  uint64_t gained = 0;
+  Bitboard result;
+  BitboardInit();
+  switch (direction) {
+  case LEFT:
+    result = MoveRows(*board, rowLeft, &gained);
+    break;
+  case RIGHT:
+    result = MoveRows(*board, rowRight, &gained);
+    break;
+  case UP:
+    result = BitboardTranspose(
+        MoveRows(BitboardTranspose(*board), rowLeft, &gained));
+    break;
+  case DOWN:
+    result = BitboardTranspose(
+        MoveRows(BitboardTranspose(*board), rowRight, &gained));
+    break;
+  default:
+    return false;
+  }
+  if (result == *board) {
+    return false;
+  }
+  *board = result;
+  if (score) {
+    *score += gained;
+  }
+  return true;
+}
+
+// One bit per cell at position `4 * index`, set when the cell is empty
+static inline uint64_t EmptyMask(Bitboard board) {
+  Bitboard x = board;
+  x |= x >> 2;
+  x |= x >> 1;
+  return ~x & 0x1111111111111111ULL;
+}
+
+uint8_t BitboardCountEmpty(Bitboard board) {
+  return __builtin_popcountll(EmptyMask(board));
+}
+
+int BitboardAddRandomTile(Bitboard *board, random_engine_t *re) {
+  uint64_t empty = EmptyMask(*board);
+  uint8_t n_available = __builtin_popcountll(empty);
+  if (n_available == 0) {
+    return -1;
+  }
+
+  int choosen = bounded_int_distribution(re, n_available);
+  while (choosen--) {
+    empty &= empty - 1;
+  }
+  uint8_t index = __builtin_ctzll(empty) / 4;
+  Bitboard exponent =
+      bernoulli_threshold_distribution(re, bernoulli_threshold(0.9)) ? 1 : 2;
+  *board |= exponent << (4 * index);
+  return index;
+}
+
+static inline bool RowsHaveMatch(Bitboard board) {
+  for (uint8_t y = 0; y < BITBOARD_SIZE; ++y) {
+    uint16_t row = (board >> (16 * y)) & ROW_MASK;
+    for (uint8_t x = 1; x < BITBOARD_SIZE; ++x) {
+      uint8_t cell = (row >> (4 * x)) & 0xF;
+      if (cell && cell < BITBOARD_MAX_EXPONENT &&
+          cell == ((row >> (4 * (x - 1))) & 0xF)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool BitboardTileMatchesAvailable(Bitboard board) {
+  return RowsHaveMatch(board) || RowsHaveMatch(BitboardTranspose(board));
+}
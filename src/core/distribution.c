@@ -3,6 +3,7 @@
 #include <stdio.h>
 
 #include <math.h>
+#include <stdlib.h>
 
 #include "random.h"
 
@@ -19,17 +20,222 @@ bool bernoulli_distribution(random_engine_t *engine, double p) {
   return uniform_real_distribution(engine, 0.0, 1.0) < p;
 }
 
+uint64_t bounded_int_distribution(random_engine_t *engine, uint64_t range) {
+  uint64_t lo;
+  uint64_t hi = random_mul128(random_engine_next(engine), range, &lo);
+  if (lo < range) {
+    // 2^64 mod range, the number of low products that would bias the result
+    uint64_t threshold = (UINT64_MAX - range + 1) % range;
+    while (lo < threshold) {
+      hi = random_mul128(random_engine_next(engine), range, &lo);
+    }
+  }
+  return hi;
+}
+
+bool bernoulli_threshold_distribution(random_engine_t *engine,
+                                      uint64_t threshold) {
+  return random_engine_next(engine) < threshold;
+}
+
+// Uniform double in [0, 1) with all 53 bits of the mantissa random
+static inline double unit_double(random_engine_t *engine) {
+  return (random_engine_next(engine) >> 11) * 0x1.0p-53;
+}
+
+// Sequential search from 0, for small means: O(n * p) steps on average
+static uint64_t binomial_inversion(random_engine_t *engine, uint64_t n,
+                                   double p) {
+  double q = 1.0 - p;
+  double qn = exp(n * log(q));
+  double np = n * p;
+  double bound = fmin((double)n, np + 10.0 * sqrt(np * q + 1));
+  uint64_t x = 0;
+  double px = qn;
+  double u = unit_double(engine);
+  while (u > px) {
+    ++x;
+    if (x > bound) {
+      // Rounding left mass in the far tail, start over
+      x = 0;
+      px = qn;
+      u = unit_double(engine);
+    } else {
+      u -= px;
+      px = ((n - x + 1) * p * px) / (x * q);
+    }
+  }
+  return x;
+}
+
+// Evaluate the acceptance test of BTPE for `y`, with `v` scaled to the hat
+static bool btpe_accept(uint64_t n, double r, double q, int64_t m, double xm,
+                        int64_t y, double v) {
+  double nrq = n * r * q;
+  int64_t k = y > m ? y - m : m - y;
+  if (k <= 20 || k >= nrq / 2.0 - 1) {
+    // Explicit ratio f(y) / f(m) of the probabilities
+    double s = r / q;
+    double a = s * (n + 1);
+    double f = 1.0;
+    if (m < y) {
+      for (int64_t i = m + 1; i <= y; ++i) {
+        f *= a / i - s;
+      }
+    } else {
+      for (int64_t i = y + 1; i <= m; ++i) {
+        f /= a / i - s;
+      }
+    }
+    return v <= f;
+  }
+
+  // Squeeze on log(f(y) / f(m)), then Stirling's approximation of it
+  double rho = (k / nrq) * ((k * (k / 3.0 + 0.625) + 0.16666666666666666) /
+                                nrq +
+                            0.5);
+  double t = -(double)k * k / (2 * nrq);
+  double alpha = log(v);
+  if (alpha < t - rho) {
+    return true;
+  }
+  if (alpha > t + rho) {
+    return false;
+  }
+  double x1 = y + 1, f1 = m + 1, z = n + 1 - m, w = n - y + 1;
+  double x2 = x1 * x1, f2 = f1 * f1, z2 = z * z, w2 = w * w;
+  double bound =
+      xm * log(f1 / x1) + (n - m + 0.5) * log(z / w) +
+      (y - m) * log(w * r / (x1 * q)) +
+      (13680. - (462. - (132. - (99. - 140. / f2) / f2) / f2) / f2) / f1 /
+          166320. +
+      (13680. - (462. - (132. - (99. - 140. / z2) / z2) / z2) / z2) / z /
+          166320. +
+      (13680. - (462. - (132. - (99. - 140. / x2) / x2) / x2) / x2) / x1 /
+          166320. +
+      (13680. - (462. - (132. - (99. - 140. / w2) / w2) / w2) / w2) / w /
+          166320.;
+  return alpha <= bound;
+}
+
+// BTPE of Kachitvichyanukul and Schmeiser, for `p <= 0.5` and large means:
+// a triangle, two parallelograms and two exponential tails cover the
+// distribution, so the expected number of draws does not depend on n
+static uint64_t binomial_btpe(random_engine_t *engine, uint64_t n, double r) {
+  double q = 1.0 - r;
+  double fm = n * r + r;
+  int64_t m = (int64_t)floor(fm);
+  double p1 = floor(2.195 * sqrt(n * r * q) - 4.6 * q) + 0.5;
+  double xm = m + 0.5;
+  double xl = xm - p1;
+  double xr = xm + p1;
+  double c = 0.134 + 20.5 / (15.3 + m);
+  double a = (fm - xl) / (fm - xl * r);
+  double laml = a * (1.0 + a / 2.0);
+  a = (xr - fm) / (xr * q);
+  double lamr = a * (1.0 + a / 2.0);
+  double p2 = p1 * (1.0 + 2.0 * c);
+  double p3 = p2 + c / laml;
+  double p4 = p3 + c / lamr;
+
+  for (;;) {
+    double u = unit_double(engine) * p4;
+    double v = unit_double(engine);
+    int64_t y;
+    if (u <= p1) {
+      // Triangle, always accepted
+      return (uint64_t)floor(xm - p1 * v + u);
+    }
+    if (u <= p2) {
+      // Parallelograms
+      double x = xl + (u - p1) / c;
+      v = v * c + 1.0 - fabs(m - x + 0.5) / p1;
+      if (v > 1.0) {
+        continue;
+      }
+      y = (int64_t)floor(x);
+    } else if (u <= p3) {
+      // Left exponential tail
+      if (v == 0.0) {
+        continue;
+      }
+      double x = floor(xl + log(v) / laml);
+      if (x < 0) {
+        continue;
+      }
+      y = (int64_t)x;
+      v = v * (u - p2) * laml;
+    } else {
+      // Right exponential tail
+      if (v == 0.0) {
+        continue;
+      }
+      double x = floor(xr - log(v) / lamr);
+      if (x > n) {
+        continue;
+      }
+      y = (int64_t)x;
+      v = v * (u - p3) * lamr;
+    }
+    if (btpe_accept(n, r, q, m, xm, y, v)) {
+      return (uint64_t)y;
+    }
+  }
+}
+
+// Means up to this use the sequential search, larger ones BTPE
+#define BINOMIAL_INVERSION_MAX_MEAN 30.0
+
 uint64_t binomial_distribution(random_engine_t *engine, uint64_t n, double p) {
-  uint64_t result = 0;
-  for (uint64_t i = 0; i < n; ++i) {
-    if (bernoulli_distribution(engine, p)) {
-      result++;
+  if (n == 0 || p <= 0.0) {
+    return 0;
+  }
+  if (p >= 1.0) {
+    return n;
+  }
+  // Sample the rarer outcome, the samplers expect p <= 0.5
+  double r = p <= 0.5 ? p : 1.0 - p;
+  uint64_t x = r * n <= BINOMIAL_INVERSION_MAX_MEAN
+                   ? binomial_inversion(engine, n, r)
+                   : binomial_btpe(engine, n, r);
+  return p <= 0.5 ? x : n - x;
+}
+
+// PTRS of Hörmann, transformed rejection with squeeze for large means: the
+// expected number of draws does not depend on lambda
+static uint64_t poisson_ptrs(random_engine_t *engine, double lambda) {
+  double slam = sqrt(lambda);
+  double loglam = log(lambda);
+  double b = 0.931 + 2.53 * slam;
+  double a = -0.059 + 0.02483 * b;
+  double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+  double vr = 0.9277 - 3.6224 / (b - 2);
+
+  for (;;) {
+    double u = unit_double(engine) - 0.5;
+    double v = unit_double(engine);
+    double us = 0.5 - fabs(u);
+    double k = floor((2 * a / us + b) * u + lambda + 0.43);
+    if (us >= 0.07 && v <= vr) {
+      return (uint64_t)k;
+    }
+    if (k < 0 || (us < 0.013 && v > us)) {
+      continue;
+    }
+    if (log(v) + log(invalpha) - log(a / (us * us) + b) <=
+        -lambda + k * loglam - lgamma(k + 1)) {
+      return (uint64_t)k;
     }
   }
-  return result;
 }
 
+// Means from this use PTRS, smaller ones the multiplication method
+#define POISSON_PTRS_MIN_LAMBDA 10.0
+
 uint64_t poisson_distribution(random_engine_t *engine, double lambda) {
+  if (lambda >= POISSON_PTRS_MIN_LAMBDA) {
+    return poisson_ptrs(engine, lambda);
+  }
   uint64_t k = 0;
   double L = exp(-lambda);
   double p = 1.0;
@@ -66,3 +272,90 @@ size_t discrete_distribution(random_engine_t *engine, const double *weights,
   }
   return size - 1;
 }
+
+struct AliasTable {
+  size_t size;
+  struct {
+    uint64_t threshold; // threshold of keeping the column, out of 2^64
+    size_t alias;       // index returned otherwise
+  } columns[];
+};
+
+alias_table_t *alias_table_ctor(const double *weights, size_t size) {
+  if (size == 0) {
+    return NULL;
+  }
+  double total_weight = 0.0;
+  for (size_t i = 0; i < size; ++i) {
+    if (!(weights[i] >= 0.0)) {
+      return NULL;
+    }
+    total_weight += weights[i];
+  }
+  if (!(total_weight > 0.0) || isinf(total_weight)) {
+    return NULL;
+  }
+
+  alias_table_t *table =
+      malloc(sizeof(alias_table_t) + size * sizeof(table->columns[0]));
+  double *scaled = malloc(size * sizeof(double));
+  size_t *worklist = malloc(size * sizeof(size_t));
+  if (!table || !scaled || !worklist) {
+    free(table);
+    free(scaled);
+    free(worklist);
+    return NULL;
+  }
+  table->size = size;
+
+  // Vose's method: columns below the average are topped up by columns above
+  // it. The worklist holds the small columns from its start and the large
+  // ones from its end.
+  size_t n_small = 0, n_large = 0;
+  for (size_t i = 0; i < size; ++i) {
+    scaled[i] = weights[i] * size / total_weight;
+    if (scaled[i] < 1.0) {
+      worklist[n_small++] = i;
+    } else {
+      worklist[size - ++n_large] = i;
+    }
+  }
+  while (n_small > 0 && n_large > 0) {
+    size_t small = worklist[--n_small];
+    size_t large = worklist[size - n_large];
+    table->columns[small].threshold = bernoulli_threshold(scaled[small]);
+    table->columns[small].alias = large;
+    scaled[large] -= 1.0 - scaled[small];
+    if (scaled[large] < 1.0) {
+      --n_large;
+      worklist[n_small++] = large;
+    }
+  }
+  // Columns left are full, up to rounding errors
+  while (n_large > 0) {
+    size_t i = worklist[size - n_large--];
+    table->columns[i].threshold = UINT64_MAX;
+    table->columns[i].alias = i;
+  }
+  while (n_small > 0) {
+    size_t i = worklist[--n_small];
+    table->columns[i].threshold = UINT64_MAX;
+    table->columns[i].alias = i;
+  }
+
+  free(scaled);
+  free(worklist);
+  return table;
+}
+
+size_t alias_table_sample(const alias_table_t *table,
+                          random_engine_t *engine) {
+  size_t i = bounded_int_distribution(engine, table->size);
+  return bernoulli_threshold_distribution(engine, table->columns[i].threshold)
+             ? i
+             : table->columns[i].alias;
+}
+
+size_t alias_table_size(const alias_table_t *table) { return table->size; }
+
+void alias_table_dtor(alias_table_t *table) { free(table); }
@@ -1,162 +1,497 @@
 #include "core/game.h"
+#include "core/replay.h"
 #include "random.h"
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-uint16_t GetDirectedIndex(Grid grid, Direction direction, uint8_t x,
-                          uint8_t y) {
-  int edge, area, a, b;
-  edge = grid->size;
-  area = edge * edge - 1;
-  a = !!(direction & 2);
-  b = direction & 1;
-  return (1 - 2 * a) * (x * (edge * b - b + 1) + b * y + edge * y * (1 - b)) +
-         a * area;
+// Offsets of the grid, of the cells and of the empty cell bitmap in the
+// block of a game, 8-byte aligned like the block itself
+#define GRID_OFFSET ((sizeof(struct Game) + 7) / 8 * 8)
+#define CELLS_OFFSET (GRID_OFFSET + (sizeof(struct Grid) + 7) / 8 * 8)
+#define EMPTY_OFFSET(size)                                                     \
+  (CELLS_OFFSET + (size_t)(size) * (size) * sizeof(uint64_t))
+
+size_t GameFootprint(uint8_t size) {
+  size_t bytes =
+      EMPTY_OFFSET(size) + GRID_EMPTY_WORDS(size * size) * sizeof(uint64_t);
+  return (bytes + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+// Lay a game out in a block of `GameFootprint(size)` bytes, with an empty
+// grid. Its engine must be set before adding tiles.
+static Game GamePlace(void *block, uint8_t size, random_engine_t *re) {
+  Game game = block;
+  Grid grid = (Grid)((uint8_t *)block + GRID_OFFSET);
+  grid->size = size;
+  grid->length = (uint16_t)size * size;
+  grid->cells = (uint64_t *)((uint8_t *)block + CELLS_OFFSET);
+  grid->empty = (uint64_t *)((uint8_t *)block + EMPTY_OFFSET(size));
+  memset(grid->cells, 0, grid->length * sizeof(uint64_t));
+  GridSync(grid);
+  game->grid = grid;
+  game->score = 0;
+  game->moves = 0;
+  game->re = re;
+  game->history = NULL;
+  game->recorder = NULL;
+  return game;
+}
+
+// Allocate the game in a single block, its engine must be set before adding
+// tiles
+static void GameAlloc(Game *game, uint8_t size, random_engine_t *re) {
+  *game = GamePlace(malloc(GameFootprint(size)), size, re);
+}
+
+void GameInitWithEngine(Game *game, uint8_t size, random_engine_t *re) {
+  GameAlloc(game, size, re);
+  GameAddRandomTiles(*game, 2);
+}
+
+void GameInitWithSeed(Game *game, uint8_t size, uint64_t seed) {
+  GameAlloc(game, size, NULL);
+  xoshiro256ss_seed(&(*game)->rng, seed);
+  GameAddRandomTiles(*game, 2);
+}
+
+bool GameInitIn(Game *game, Arena arena, uint8_t size, uint64_t seed) {
+  void *block = ArenaAlloc(arena, GameFootprint(size));
+  if (!block) {
+    *game = NULL;
+    return false;
+  }
+  *game = GamePlace(block, size, NULL);
+  xoshiro256ss_seed(&(*game)->rng, seed);
+  GameAddRandomTiles(*game, 2);
+  return true;
 }
 
 void GameInit(Game *game, uint8_t size) {
-  *game = (Game)malloc(sizeof(struct Game));
-  Grid grid;
-  GridInit(&grid, size);
-  (*game)->grid = grid;
-  (*game)->score = 0;
-  (*game)->moves = 0;
-  (*game)->re = Xoshiro256ssEngine.ctor();
+  GameAlloc(game, size, NULL);
+  random_device_t *rd = random_device_ctor();
+  if (!rd || !xoshiro256ss_seed_rd(&(*game)->rng, rd)) {
+    fprintf(stderr, "Failed to read the random device\n");
+    exit(1);
+  }
+  random_device_dtor(rd);
   GameAddRandomTiles(*game, 2);
 }
 
-bool GameMove(Game game, Direction direction, uint16_t *diff) {
-  bool moved = false;
-  uint8_t x, y, xx;
-  uint16_t index;
+// Progress of a line during a move
+typedef struct LineState {
+  uint16_t target; // position of the next tile placed in the line
+  bool mergeable;  // whether the last placed tile can still merge
+  int32_t last;    // trace entry of the last placed tile, -1 if none
+} LineState;
+
+// Changes to the summary of the grid during a move, applied once it is done.
+// Tiles leaving and filling cells flip their bits in the empty cell bitmap:
+// grids of a single word gather the flips in `flips`, kept in a register
+// rather than written back to the bitmap for every tile.
+typedef struct MoveSummary {
+  uint64_t *empty;  // bitmap of grids of several words, NULL otherwise
+  uint64_t flips;   // flipped bits of grids of a single word
+  uint16_t merged;  // number of merges, each one empties a cell
+  uint64_t maxTile; // largest tile made by a merge
+} MoveSummary;
+
+static inline void FlipEmpty(MoveSummary *summary, uint16_t index) {
+  if (summary->empty) {
+    summary->empty[index / 64] ^= (uint64_t)1 << (index % 64);
+  } else {
+    summary->flips ^= (uint64_t)1 << index;
+  }
+}
+
+// Slide and merge lines one cell at a time: each tile is either merged into
+// the last placed tile of its line, or placed right after it. Tiles are only
+// written to cells already visited, so the lines are rewritten in place.
+// `line` points at the cell the tiles move towards and `step` walks the line
+// towards `x`, the position of the cell within the line. `index` and
+// `indexStep` give the grid index of the same cells. The bitmap of `summary`
+// is updated as tiles leave and fill cells. Returns the number of entries
+// added after the `n_trace` first ones of `trace`. Always inlined, it grew
+// past what the compiler inlines by itself.
+static inline __attribute__((always_inline)) uint16_t
+MoveCell(MoveSummary *summary, LineState *state, uint64_t *line,
+         ptrdiff_t step, int32_t index, int32_t indexStep, uint16_t x,
+         uint64_t *score, uint16_t *diff, TileMove *trace, uint16_t n_trace) {
+  uint64_t value = line[x * step];
+  if (value == 0) {
+    return 0;
+  }
+  uint16_t from = index + x * indexStep;
+  uint16_t target = state->target;
+  if (state->mergeable && line[(target - 1) * step] == value) {
+    uint16_t to = index + (target - 1) * indexStep;
+    int32_t last = state->last;
+    line[(target - 1) * step] = value << 1;
+    line[x * step] = 0;
+    FlipEmpty(summary, from);
+    ++summary->merged;
+    if (value << 1 > summary->maxTile) {
+      summary->maxTile = value << 1;
+    }
+    *score += value << 1;
+    state->mergeable = false;
+    if (diff) {
+      diff[from] = to;
+    }
+    if (trace) {
+      if (last == -1) {
+        // The tile merged into did not move, list it as well
+        trace[n_trace] = (TileMove){to, to, true, value << 1};
+      } else {
+        trace[last].merged = true;
+        trace[last].value = value << 1;
+      }
+      trace[n_trace + (last == -1)] = (TileMove){from, to, true, value << 1};
+    }
+    return 1 + (last == -1);
+  }
+  state->mergeable = true;
+  state->last = -1;
+  state->target = target + 1;
+  if (target == x) {
+    return 0;
+  }
+  uint16_t to = index + target * indexStep;
+  line[target * step] = value;
+  line[x * step] = 0;
+  FlipEmpty(summary, from);
+  FlipEmpty(summary, to);
+  if (diff) {
+    diff[from] = to;
+  }
+  if (trace) {
+    state->last = n_trace;
+    trace[n_trace] = (TileMove){from, to, false, value};
+  }
+  return 1;
+}
+
+static uint16_t MoveLines(Game game, Direction direction, uint16_t *diff,
+                          TileMove *trace) {
   Grid grid = game->grid;
-  // Initialize the diff array with the identity mapping
-  for (size_t i = 0; i < grid->length; ++i) {
-    diff[i] = i;
+  uint16_t size = grid->size;
+  bool vertical = direction == UP || direction == DOWN;
+  bool reverse = direction == RIGHT || direction == DOWN;
+  // Lines are rows, or columns for vertical moves, and start at the cell the
+  // tiles move towards
+  int32_t step = vertical ? size : 1;
+  int32_t lineStep = vertical ? 1 : size;
+  int32_t start = reverse ? (size - 1) * step : 0;
+  if (reverse) {
+    step = -step;
   }
-  for (y = 0; y < grid->size; ++y) {
-    uint16_t previous = GetDirectedIndex(grid, direction, 0, y);
-    for (x = 1; x < grid->size; ++x) {
-      index = GetDirectedIndex(grid, direction, x, y);
-      if (grid->cells[index]) {
-        if (grid->cells[index] == grid->cells[previous]) {
-          grid->cells[previous] <<= 1;
-          grid->cells[index] = 0;
-          game->score += grid->cells[previous];
-          moved = true;
-          diff[index] = previous;
-        }
-        previous = index;
+
+  LineState lines[UINT8_MAX];
+  for (uint16_t y = 0; y < size; ++y) {
+    lines[y] = (LineState){0, false, -1};
+  }
+  MoveSummary summary = {grid->length > 64 ? grid->empty : NULL, 0, 0, 0};
+  uint64_t *cells = grid->cells;
+  uint16_t n_trace = 0;
+  if (!vertical) {
+    for (uint16_t y = 0; y < size; ++y) {
+      int32_t index = y * lineStep + start;
+      for (uint16_t x = 0; x < size; ++x) {
+        n_trace += MoveCell(&summary, &lines[y], cells + index, step, index,
+                            step, x, &game->score, diff, trace, n_trace);
       }
     }
-    for (x = 0; x < grid->size; ++x) {
-      index = GetDirectedIndex(grid, direction, x, y);
-      if (grid->cells[index] == 0) {
-        for (xx = x + 1; xx < grid->size; ++xx) {
-          uint16_t next = GetDirectedIndex(grid, direction, xx, y);
-          if (grid->cells[next]) {
-            grid->cells[index] = grid->cells[next];
-            grid->cells[next] = 0;
-            moved = true;
-            diff[next] = index;
-            break;
-          }
-        }
+  } else {
+    // Walk every column at once, row after row, so the cells are visited in
+    // memory order rather than one column at a time
+    for (uint16_t x = 0; x < size; ++x) {
+      for (uint16_t y = 0; y < size; ++y) {
+        int32_t index = y + start;
+        n_trace += MoveCell(&summary, &lines[y], cells + index, step, index,
+                            step, x, &game->score, diff, trace, n_trace);
       }
     }
   }
-  for (size_t i = 0; i < grid->length; ++i) {
-    if (diff[i] != i) {
-      uint16_t new_index = diff[i];
-      while (diff[new_index] != new_index) {
-        new_index = diff[new_index];
-      }
-      diff[i] = new_index;
+  if (n_trace > 0) {
+    if (!summary.empty) {
+      grid->empty[0] ^= summary.flips;
+    }
+    grid->n_empty += summary.merged;
+    if (summary.maxTile > grid->maxTile) {
+      grid->maxTile = summary.maxTile;
     }
+    grid->hasPair = -1;
   }
-  return moved;
+  return n_trace;
 }
 
-int GameAddRandomTile(Game game) {
-  random_engine_t *re = game->re;
-  Grid grid = game->grid;
-  uint8_t len = grid->length;
+static bool Move(Game game, Direction direction, uint16_t *diff) {
+  if (diff == NULL) {
+    return MoveLines(game, direction, NULL, NULL) > 0;
+  }
+  // Initialize the diff array with the identity mapping
+  for (size_t i = 0; i < game->grid->length; ++i) {
+    diff[i] = i;
+  }
+  return MoveLines(game, direction, diff, NULL) > 0;
+}
 
-  uint16_t available[len];
-  uint16_t n_available = GridGetAvailableCells(game->grid, available, len);
-  if (n_available == 0) {
-    return -1;
+// Save a keyframe before the grid changes, if the history is recorded
+static inline void Checkpoint(Game game) {
+  if (game->history) {
+    HistoryCheckpoint(game->history, game->grid->cells, game->score,
+                      game->moves);
   }
+}
 
-  uint16_t index = available[uniform_int_distribution(re, 0, n_available - 1)];
-  grid->cells[index] = bernoulli_distribution(re, 0.9)
-                           ? 2
-                           : 4; // 90% chance of 2, 10% chance of 4
-  return index;
+// Record a move that moved the tiles
+static inline void RecordMove(Game game, Direction direction) {
+  if (game->history) {
+    HistoryRecordMove(game->history, direction);
+  }
+  if (game->recorder) {
+    ReplayRecordMove(game->recorder, direction);
+  }
 }
 
-static inline void ArrayErase(uint16_t *array, uint8_t len, uint8_t index) {
-  for (; index < len - 1; ++index) {
-    array[index] = array[index + 1];
+bool GameMove(Game game, Direction direction, uint16_t *diff) {
+  Checkpoint(game);
+  if (game->recorder) {
+    ReplayRecorderCheckpoint(game->recorder, game);
   }
+  bool moved = Move(game, direction, diff);
+  if (moved) {
+    RecordMove(game, direction);
+  }
+  return moved;
 }
 
-bool GameAddRandomTiles(Game game, uint16_t n_tiles) {
-  bool added = true;
+bool GameMoveTrace(Game game, Direction direction, TileMove *trace,
+                   uint16_t *n_trace) {
+  Checkpoint(game);
+  if (game->recorder) {
+    ReplayRecorderCheckpoint(game->recorder, game);
+  }
+  *n_trace = MoveLines(game, direction, NULL, trace);
+  if (*n_trace > 0) {
+    RecordMove(game, direction);
+  }
+  return *n_trace > 0;
+}
+
+// 90% chance of 2, 10% chance of 4
+#define TWO_PROBABILITY 0.9
+
+// Place a tile on one of the `n_available` available cells, picked uniformly
+static uint16_t PlaceRandomTile(Game game, uint16_t n_available) {
   random_engine_t *re = game->re;
   Grid grid = game->grid;
-  uint8_t len = grid->length;
+  uint64_t threshold = bernoulli_threshold(TWO_PROBABILITY);
+  uint16_t nth;
+  bool two;
+  if (re) {
+    nth = bounded_int_distribution(re, n_available);
+    two = bernoulli_threshold_distribution(re, threshold);
+  } else {
+    nth = xoshiro256ss_bounded(&game->rng, n_available);
+    two = xoshiro256ss_bernoulli_threshold(&game->rng, threshold);
+  }
+  uint16_t index = GridGetNthAvailableCell(grid, nth);
+  Checkpoint(game);
+  GridSetCell(grid, index, two ? 2 : 4);
+  if (game->history) {
+    HistoryRecordSpawn(game->history, index, two ? 1 : 2);
+  }
+  if (game->recorder) {
+    ReplayRecordSpawn(game->recorder);
+  }
+  return index;
+}
+
+int GameAddRandomTile(Game game) {
+  uint16_t n_available = GridCountAvailableCells(game->grid);
+  if (n_available == 0) {
+    return -1;
+  }
+  return PlaceRandomTile(game, n_available);
+}
 
-  uint16_t available[len];
-  uint16_t n_available = GridGetAvailableCells(game->grid, available, len);
+bool GameAddRandomTiles(Game game, uint16_t n_tiles) {
+  uint16_t n_available = GridCountAvailableCells(game->grid);
   if (n_available == 0) {
     return false;
   }
 
   while (n_tiles--) {
     if (n_available == 0) {
-      added = false;
-      break;
+      return false;
     }
-    uint8_t choosen = uniform_int_distribution(re, 0, n_available - 1);
-    uint16_t index = available[choosen];
-    ArrayErase(available, n_available,
-               choosen); // n_available instead of len cuz it's smaller
-    --n_available;
+    PlaceRandomTile(game, n_available--);
+  }
+  return true;
+}
 
-    grid->cells[index] = bernoulli_distribution(re, 0.9) ? 2 : 4;
+bool GameTileMatchesAvailable(Game game) {
+  return GridHasPair(game->grid);
+}
+
+bool GameCanMove(Game game) {
+  return GridAnyCellAvailable(game->grid) || GridHasPair(game->grid);
+}
+
+void GameReset(Game game) {
+  // The new game is recorded as a whole, once its tiles are dealt
+  History history = game->history;
+  struct ReplayRecorder *recorder = game->recorder;
+  game->history = NULL;
+  game->recorder = NULL;
+  memset(game->grid->cells, 0, game->grid->length * sizeof(uint64_t));
+  GridSync(game->grid);
+  game->score = 0;
+  game->moves = 0;
+  GameAddRandomTiles(game, 2);
+  game->history = history;
+  game->recorder = recorder;
+  if (history) {
+    // The new game starts the history
+    HistoryClear(history);
+    Checkpoint(game);
   }
+  if (recorder) {
+    ReplayRecordState(recorder, game);
+  }
+}
 
-  return added;
+bool GameRecordHistory(Game game, uint32_t capacity) {
+  History history;
+  if (!HistoryInit(&history, game->grid->length, capacity)) {
+    return false;
+  }
+  if (game->history) {
+    HistoryFree(&game->history);
+  }
+  game->history = history;
+  Checkpoint(game);
+  return true;
 }
 
-bool GameTileMatchesAvailable(Game game) {
-  Direction direction;
-  Grid grid = game->grid;
+// Replay a delta of the history, the moves are counted
+static void ApplyDelta(Game game, const HistoryDelta *delta) {
+  if (delta->direction != HISTORY_NO_MOVE) {
+    Move(game, delta->direction, NULL);
+    ++game->moves;
+  }
+  if (delta->spawnExponent) {
+    GridSetCell(game->grid, delta->spawnIndex,
+                (uint64_t)1 << delta->spawnExponent);
+  }
+}
 
-  for (direction = 0; direction < 2; ++direction) {
-    uint16_t x, y;
-    for (y = 0; y < grid->size; ++y) {
-      for (x = 1; x < grid->size; ++x) {
-        uint16_t index = GetDirectedIndex(grid, direction, x, y);
-        if (grid->cells[index]) {
-          uint16_t neighbor = GetDirectedIndex(grid, direction, x - 1, y);
-          if (grid->cells[index] == grid->cells[neighbor]) {
-            return true;
-          }
-        }
-      }
-    }
+bool GameUndo(Game game) {
+  History history = game->history;
+  if (!history || history->position == history->first) {
+    return false;
+  }
+  uint64_t target = history->position - 1;
+  uint64_t state = HistoryRestoreKeyframe(history, target, game->grid->cells,
+                                          &game->score, &game->moves);
+  GridSync(game->grid);
+  for (; state < target; ++state) {
+    ApplyDelta(game, HistoryDeltaAt(history, state));
+  }
+  history->position = target;
+  if (game->recorder) {
+    ReplayRecordState(game->recorder, game);
+  }
+  return true;
+}
+
+bool GameRedo(Game game) {
+  History history = game->history;
+  if (!history || history->position == history->end) {
+    return false;
+  }
+  ApplyDelta(game, HistoryDeltaAt(history, history->position));
+  ++history->position;
+  if (game->recorder) {
+    ReplayRecordState(game->recorder, game);
+  }
+  return true;
+}
+
+bool GameRecordReplay(Game game, FILE *stream) {
+  ReplayRecorder recorder;
+  if (!ReplayRecorderInit(&recorder, game, stream)) {
+    return false;
+  }
+  GameStopReplay(game);
+  game->recorder = recorder;
+  return true;
+}
+
+bool GameStopReplay(Game game) {
+  if (!game->recorder) {
+    return true;
   }
-  return false;
+  return ReplayRecorderFree(&game->recorder);
+}
+
+bool GamePoolInit(GamePool *pool, uint8_t size, uint32_t capacity) {
+  *pool = malloc(sizeof(struct GamePool));
+  if (!*pool) {
+    return false;
+  }
+  // Blocks handed out by the arena are padded to its alignment
+  size_t footprint = GameFootprint(size);
+  size_t list = ((size_t)capacity * sizeof(Game) + ARENA_ALIGNMENT - 1) /
+                ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+  size_t bytes = list + (size_t)capacity * footprint;
+  if (!ArenaInit(&(*pool)->arena, bytes)) {
+    free(*pool);
+    *pool = NULL;
+    return false;
+  }
+  (*pool)->size = size;
+  (*pool)->capacity = capacity;
+  (*pool)->free = ArenaAlloc((*pool)->arena, capacity * sizeof(Game));
+  // Every game starts on the free list, the first one on top
+  for (uint32_t i = capacity; i-- > 0;) {
+    (*pool)->free[i] =
+        GamePlace(ArenaAlloc((*pool)->arena, footprint), size, NULL);
+  }
+  (*pool)->n_free = capacity;
+  return true;
+}
+
+Game GamePoolAcquire(GamePool pool, uint64_t seed) {
+  if (pool->n_free == 0) {
+    return NULL;
+  }
+  Game game = pool->free[--pool->n_free];
+  game->re = NULL;
+  xoshiro256ss_seed(&game->rng, seed);
+  GameReset(game);
+  return game;
+}
+
+void GamePoolRelease(GamePool pool, Game game) {
+  pool->free[pool->n_free++] = game;
+}
+
+void GamePoolFree(GamePool *pool) {
+  ArenaFree(&(*pool)->arena);
+  free(*pool);
+  *pool = NULL;
 }
 
 void GameFree(Game *game) {
-  // Free the memory allocated for the game
-  GridFree(&(*game)->grid);
-  random_engine_dtor((*game)->re);
+  if ((*game)->history) {
+    HistoryFree(&(*game)->history);
+  }
+  GameStopReplay(*game);
+  // The grid and its cells are part of the block of the game
   free(*game);
   *game = NULL;
 }
@@ -0,0 +1,366 @@
+#include "core/game_batch.h"
+#include "xoshiro256ss.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// Alignment of every array of the batch, a cache line
+#define BATCH_ALIGNMENT 64
+#define BLOCK GAME_BATCH_BLOCK
+#define MAX_LENGTH (GAME_BATCH_MAX_SIZE * GAME_BATCH_MAX_SIZE)
+// Chance of a 2 out of 2^32, 90% like `GameAddRandomTile`
+#define TWO_THRESHOLD ((uint64_t)(0.9 * 4294967296.0))
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// All bits set when `condition` holds, none otherwise
+#define MASK(condition) ((uint8_t)(0 - (condition)))
+
+bool GameBatchInit(GameBatch *batch, uint8_t size, uint32_t count,
+                   uint64_t seed) {
+  *batch = NULL;
+  if (size == 0 || size > GAME_BATCH_MAX_SIZE || count == 0) {
+    return false;
+  }
+  GameBatch result = malloc(sizeof(struct GameBatch));
+  if (!result) {
+    return false;
+  }
+  result->size = size;
+  result->length = (uint16_t)size * size;
+  result->count = count;
+  result->stride = (count + BLOCK - 1) / BLOCK * BLOCK;
+  size_t stride = result->stride;
+  // Every array is a whole number of cache lines, so each starts aligned
+  size_t bytes = stride * (4 * sizeof(uint64_t) + sizeof(uint64_t) +
+                           sizeof(uint32_t) + result->length);
+  result->buffer = calloc(1, bytes + BATCH_ALIGNMENT - 1);
+  if (!result->buffer) {
+    free(result);
+    return false;
+  }
+  uintptr_t aligned = ((uintptr_t)result->buffer + BATCH_ALIGNMENT - 1) /
+                      BATCH_ALIGNMENT * BATCH_ALIGNMENT;
+  result->rng = (uint64_t *)aligned;
+  result->score = result->rng + 4 * stride;
+  result->moves = (uint32_t *)(result->score + stride);
+  result->cells = (uint8_t *)(result->moves + stride);
+
+  // Padding boards past `count` stay empty, their null state draws zeros
+  xoshiro256ss_t rng;
+  xoshiro256ss_seed(&rng, seed);
+  for (uint32_t b = 0; b < count; ++b) {
+    for (int w = 0; w < 4; ++w) {
+      result->rng[w * stride + b] = rng.state[w];
+    }
+    xoshiro256ss_jump_state(&rng);
+  }
+  GameBatchSpawn(result, NULL);
+  GameBatchSpawn(result, NULL);
+  *batch = result;
+  return true;
+}
+
+static inline uint64_t Rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+// Step the random states of the boards of a block
+static void StepRandom(GameBatch batch, uint32_t b0, uint64_t *restrict out) {
+  uint64_t *restrict s0 = batch->rng + b0;
+  uint64_t *restrict s1 = s0 + batch->stride;
+  uint64_t *restrict s2 = s1 + batch->stride;
+  uint64_t *restrict s3 = s2 + batch->stride;
+  for (uint32_t b = 0; b < BLOCK; ++b) {
+    uint64_t times5 = s1[b] + (s1[b] << 2);
+    uint64_t rotated = Rotl(times5, 7);
+    out[b] = rotated + (rotated << 3);
+    uint64_t t = s1[b] << 17;
+    s2[b] ^= s0[b];
+    s3[b] ^= s1[b];
+    s1[b] ^= s2[b];
+    s0[b] ^= s3[b];
+    s2[b] ^= t;
+    s3[b] = Rotl(s3[b], 45);
+  }
+}
+
+// Turn the draw `x` into the index of an available cell among `n` and a tile
+// exponent. The high half of `x` picks the cell with Lemire's method on 32
+// bits, the low half picks the tile. Returns false if the pick is biased, to
+// draw again.
+static inline bool PickSpawn(uint64_t x, uint32_t n, uint16_t *nth,
+                             uint8_t *exponent) {
+  uint64_t product = (x >> 32) * n;
+  *nth = product >> 32;
+  *exponent = (x & UINT32_MAX) < TWO_THRESHOLD ? 1 : 2;
+  uint32_t low = (uint32_t)product;
+  return low >= n || low >= (0 - n) % n;
+}
+
+// Draw again for a single board until its pick is unbiased
+static void RedrawSpawn(GameBatch batch, uint32_t b, uint32_t n,
+                        uint16_t *nth, uint8_t *exponent) {
+  xoshiro256ss_t rng;
+  for (int w = 0; w < 4; ++w) {
+    rng.state[w] = batch->rng[w * batch->stride + b];
+  }
+  while (!PickSpawn(xoshiro256ss_step(&rng), n, nth, exponent)) {
+  }
+  for (int w = 0; w < 4; ++w) {
+    batch->rng[w * batch->stride + b] = rng.state[w];
+  }
+}
+
+uint32_t GameBatchSpawn(GameBatch batch, const bool *mask) {
+  uint32_t spawned = 0;
+  for (uint32_t b0 = 0; b0 < batch->count; b0 += BLOCK) {
+    uint32_t n = MIN(batch->count - b0, BLOCK);
+    uint16_t available[BLOCK] = {0}, nth[BLOCK];
+    uint8_t exponent[BLOCK];
+    uint64_t draw[BLOCK];
+    for (uint16_t i = 0; i < batch->length; ++i) {
+      const uint8_t *restrict cell = batch->cells + i * batch->stride + b0;
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        available[b] += cell[b] == 0;
+      }
+    }
+    for (uint32_t b = 0; b < BLOCK; ++b) {
+      if (b >= n || (mask && !mask[b0 + b])) {
+        available[b] = 0;
+      }
+    }
+
+    // Masked out and full boards draw as well, so that the stream of a board
+    // does not depend on the others
+    StepRandom(batch, b0, draw);
+    bool biased = false;
+    for (uint32_t b = 0; b < BLOCK; ++b) {
+      uint64_t product = (draw[b] >> 32) * available[b];
+      nth[b] = product >> 32;
+      exponent[b] = (draw[b] & UINT32_MAX) < TWO_THRESHOLD ? 1 : 2;
+      biased |= (uint32_t)product < available[b];
+    }
+    // Rare, a pick may only be biased if the low half is below the range
+    for (uint32_t b = 0; biased && b < n; ++b) {
+      if (available[b] &&
+          !PickSpawn(draw[b], available[b], &nth[b], &exponent[b])) {
+        RedrawSpawn(batch, b0 + b, available[b], &nth[b], &exponent[b]);
+      }
+    }
+
+    // The tile goes where the count of available cells left to skip reaches
+    // 0, boards without any never reach it
+    for (uint32_t b = 0; b < BLOCK; ++b) {
+      spawned += available[b] != 0;
+      nth[b] = available[b] ? nth[b] : UINT16_MAX;
+    }
+    for (uint16_t i = 0; i < batch->length; ++i) {
+      uint8_t *restrict cell = batch->cells + i * batch->stride + b0;
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        uint8_t empty = MASK(cell[b] == 0);
+        cell[b] |= exponent[b] & empty & MASK(nth[b] == 0);
+        nth[b] -= empty & 1;
+      }
+    }
+  }
+  return spawned;
+}
+
+void GameBatchReset(GameBatch batch, uint32_t board) {
+  for (uint16_t i = 0; i < batch->length; ++i) {
+    batch->cells[i * batch->stride + board] = 0;
+  }
+  batch->score[board] = 0;
+  batch->moves[board] = 0;
+  for (uint16_t tile = 0; tile < 2 && tile < batch->length; ++tile) {
+    uint16_t nth;
+    uint8_t exponent;
+    RedrawSpawn(batch, board, batch->length - tile, &nth, &exponent);
+    for (uint16_t i = 0;; ++i) {
+      uint8_t *cell = &batch->cells[i * batch->stride + board];
+      if (*cell == 0 && nth-- == 0) {
+        *cell = exponent;
+        break;
+      }
+    }
+  }
+}
+
+void GameBatchGetBoard(GameBatch batch, uint32_t board, uint64_t *cells) {
+  for (uint16_t i = 0; i < batch->length; ++i) {
+    uint8_t exponent = batch->cells[i * batch->stride + board];
+    cells[i] = exponent ? (uint64_t)1 << exponent : 0;
+  }
+}
+
+void GameBatchSetBoard(GameBatch batch, uint32_t board,
+                       const uint64_t *cells) {
+  for (uint16_t i = 0; i < batch->length; ++i) {
+    batch->cells[i * batch->stride + board] =
+        cells[i] ? __builtin_ctzll(cells[i]) : 0;
+  }
+}
+
+// Index of the cell at position `x` of line `line`, counted from the cell
+// the tiles move towards
+static inline uint16_t LineCell(uint8_t size, Direction direction,
+                                uint16_t line, uint16_t x) {
+  switch (direction) {
+  case LEFT:
+    return line * size + x;
+  case RIGHT:
+    return line * size + (size - 1 - x);
+  case UP:
+    return x * size + line;
+  default:
+    return (size - 1 - x) * size + line;
+  }
+}
+
+// Slide the tiles of a line of `n` cells towards its first cell, empty cells
+// bubble to the end: after pass `p` the last `p` cells are settled
+static void SlideLine(uint8_t (*restrict line)[BLOCK], uint8_t n) {
+  for (uint8_t pass = 1; pass < n; ++pass) {
+    for (uint8_t k = 0; k + pass < n; ++k) {
+      uint8_t *restrict a = line[k], *restrict c = line[k + 1];
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        uint8_t empty = MASK(a[b] == 0);
+        a[b] |= c[b] & empty;
+        c[b] &= ~empty;
+      }
+    }
+  }
+}
+
+// Move the turned boards of a block left: slide, merge pairs from the first
+// cell on, slide again
+static void MoveLeft(uint8_t size, uint8_t (*restrict turned)[BLOCK],
+                     uint64_t *restrict gained) {
+  for (uint16_t line = 0; line < size; ++line) {
+    uint8_t(*restrict cells)[BLOCK] = turned + line * size;
+    SlideLine(cells, size);
+    for (uint8_t k = 0; k + 1 < size; ++k) {
+      uint8_t *restrict a = cells[k], *restrict c = cells[k + 1];
+      uint8_t merged[BLOCK];
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        // The emptied cell cannot merge with the next one
+        uint8_t merge = MASK(a[b] != 0 && a[b] == c[b]);
+        a[b] += merge & 1;
+        c[b] &= ~merge;
+        merged[b] = a[b] & merge;
+      }
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        gained[b] += (uint64_t)(merged[b] != 0) << merged[b];
+      }
+    }
+    SlideLine(cells, size);
+  }
+}
+
+uint32_t GameBatchMove(GameBatch batch, const Direction *directions,
+                       bool *moved) {
+  uint8_t size = batch->size;
+  uint16_t length = batch->length;
+  size_t stride = batch->stride;
+  // Every board is turned to move left: cell `i` of a board moving in
+  // direction `d` is cell `turned[d][i]` of the turned board
+  uint16_t turned[4][MAX_LENGTH];
+  for (Direction d = LEFT; d <= DOWN; ++d) {
+    for (uint16_t i = 0; i < length; ++i) {
+      turned[d][LineCell(size, d, i / size, i % size)] = i;
+    }
+  }
+  uint32_t n_moved = 0;
+  for (uint32_t b0 = 0; b0 < batch->count; b0 += BLOCK) {
+    uint32_t n = MIN(batch->count - b0, BLOCK);
+    uint8_t is[4][BLOCK], changed[BLOCK] = {0};
+    uint8_t board[MAX_LENGTH][BLOCK];
+    uint64_t gained[BLOCK] = {0};
+    for (uint32_t b = 0; b < BLOCK; ++b) {
+      // Padding boards are empty, any direction leaves them unchanged
+      Direction direction = b < n ? directions[b0 + b] : LEFT;
+      for (Direction d = LEFT; d <= DOWN; ++d) {
+        is[d][b] = MASK(direction == d);
+      }
+    }
+    for (uint16_t i = 0; i < length; ++i) {
+      const uint8_t *restrict from[4];
+      for (Direction d = LEFT; d <= DOWN; ++d) {
+        from[d] =
+            batch->cells + LineCell(size, d, i / size, i % size) * stride + b0;
+      }
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        board[i][b] = (from[LEFT][b] & is[LEFT][b]) |
+                      (from[UP][b] & is[UP][b]) |
+                      (from[RIGHT][b] & is[RIGHT][b]) |
+                      (from[DOWN][b] & is[DOWN][b]);
+      }
+    }
+
+    MoveLeft(size, board, gained);
+
+    // Turn the boards back, a board moved if any of its cells changed
+    for (uint16_t i = 0; i < length; ++i) {
+      uint8_t *restrict cell = batch->cells + i * stride + b0;
+      const uint8_t *restrict from[4];
+      for (Direction d = LEFT; d <= DOWN; ++d) {
+        from[d] = board[turned[d][i]];
+      }
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        uint8_t value = (from[LEFT][b] & is[LEFT][b]) |
+                        (from[UP][b] & is[UP][b]) |
+                        (from[RIGHT][b] & is[RIGHT][b]) |
+                        (from[DOWN][b] & is[DOWN][b]);
+        changed[b] |= value ^ cell[b];
+        cell[b] = value;
+      }
+    }
+
+    for (uint32_t b = 0; b < n; ++b) {
+      bool boardMoved = changed[b] != 0;
+      batch->score[b0 + b] += gained[b];
+      batch->moves[b0 + b] += boardMoved;
+      n_moved += boardMoved;
+      if (moved) {
+        moved[b0 + b] = boardMoved;
+      }
+    }
+  }
+  return n_moved;
+}
+
+uint32_t GameBatchAlive(GameBatch batch, bool *alive) {
+  uint8_t size = batch->size;
+  size_t stride = batch->stride;
+  uint32_t n_alive = 0;
+  for (uint32_t b0 = 0; b0 < batch->count; b0 += BLOCK) {
+    uint32_t n = MIN(batch->count - b0, BLOCK);
+    uint8_t blockAlive[BLOCK] = {0};
+    // Every cell is compared with its right and bottom neighbors, cells
+    // without one compare with themselves, masked out
+    for (uint16_t i = 0; i < batch->length; ++i) {
+      const uint8_t *restrict cell = batch->cells + i * stride + b0;
+      uint8_t hasRight = MASK(i % size + 1 < size);
+      uint8_t hasBelow = MASK(i + size < batch->length);
+      const uint8_t *restrict right = hasRight ? cell + stride : cell;
+      const uint8_t *restrict below = hasBelow ? cell + size * stride : cell;
+      for (uint32_t b = 0; b < BLOCK; ++b) {
+        blockAlive[b] |= MASK(cell[b] == 0) |
+                         (MASK(cell[b] == right[b]) & hasRight) |
+                         (MASK(cell[b] == below[b]) & hasBelow);
+      }
+    }
+    for (uint32_t b = 0; b < n; ++b) {
+      alive[b0 + b] = blockAlive[b] != 0;
+      n_alive += alive[b0 + b];
+    }
+  }
+  return n_alive;
+}
+
+void GameBatchFree(GameBatch *batch) {
+  free((*batch)->buffer);
+  free(*batch);
+  *batch = NULL;
+}
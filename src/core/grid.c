@@ -1,12 +1,132 @@
 #include "core/grid.h"
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 void GridInit(Grid * grid, uint8_t size) {
     *grid = malloc(sizeof(struct Grid));
     (*grid)->size = size;
     (*grid)->length = (uint16_t) size * size;
     (*grid)->cells = calloc((*grid)->length, sizeof(uint64_t));
+    (*grid)->empty = malloc(GRID_EMPTY_WORDS((*grid)->length) * sizeof(uint64_t));
+    GridSync(*grid);
+}
+
+void GridSync(Grid grid) {
+    const uint64_t * cells = grid->cells;
+    uint16_t length = grid->length;
+    uint16_t n_empty = 0;
+    uint64_t maxTile = 0;
+    for (uint16_t first = 0; first < length; first += 64) {
+        uint16_t count = length - first < 64 ? length - first : 64;
+        const uint64_t * word = cells + first;
+        uint64_t bits = 0;
+        uint16_t i = 0;
+        // Eight cells at a time, their bits do not depend on each other
+        for (; i + 8 <= count; i += 8) {
+            uint64_t byte = (uint64_t) (word[i] == 0) |
+                            (uint64_t) (word[i + 1] == 0) << 1 |
+                            (uint64_t) (word[i + 2] == 0) << 2 |
+                            (uint64_t) (word[i + 3] == 0) << 3 |
+                            (uint64_t) (word[i + 4] == 0) << 4 |
+                            (uint64_t) (word[i + 5] == 0) << 5 |
+                            (uint64_t) (word[i + 6] == 0) << 6 |
+                            (uint64_t) (word[i + 7] == 0) << 7;
+            bits |= byte << i;
+        }
+        for (; i < count; ++i) {
+            bits |= (uint64_t) (word[i] == 0) << i;
+        }
+        grid->empty[first / 64] = bits;
+        n_empty += __builtin_popcountll(bits);
+    }
+    for (uint16_t i = 0; i < length; ++i) {
+        maxTile = cells[i] > maxTile ? cells[i] : maxTile;
+    }
+    grid->n_empty = n_empty;
+    grid->maxTile = maxTile;
+    // Looked for when it is first needed, full grids are rare
+    grid->hasPair = -1;
+}
+
+void GridCopy(Grid to, Grid from) {
+    memcpy(to->cells, from->cells, from->length * sizeof(uint64_t));
+    memcpy(to->empty, from->empty,
+           GRID_EMPTY_WORDS(from->length) * sizeof(uint64_t));
+    to->n_empty = from->n_empty;
+    to->maxTile = from->maxTile;
+    to->hasPair = from->hasPair;
+}
+
+// Whether the tile at the given index has a neighbor of the same value
+static bool HasEqualNeighbor(Grid grid, uint16_t index) {
+    uint16_t size = grid->size;
+    uint16_t x = index % size;
+    uint64_t value = grid->cells[index];
+    return (x > 0 && grid->cells[index - 1] == value) ||
+           (x + 1 < size && grid->cells[index + 1] == value) ||
+           (index >= size && grid->cells[index - size] == value) ||
+           (index + size < grid->length && grid->cells[index + size] == value);
+}
+
+void GridSetCell(Grid grid, uint16_t index, uint64_t value) {
+    uint64_t old = grid->cells[index];
+    if (old == value) {
+        return;
+    }
+    grid->cells[index] = value;
+    uint64_t bit = (uint64_t) 1 << (index % 64);
+    if (old == 0) {
+        grid->empty[index / 64] &= ~bit;
+        --grid->n_empty;
+    } else if (value == 0) {
+        grid->empty[index / 64] |= bit;
+        ++grid->n_empty;
+    }
+    if (value > grid->maxTile) {
+        grid->maxTile = value;
+    } else if (old == grid->maxTile) {
+        // The largest tile shrank, another cell may hold it as well
+        uint64_t maxTile = 0;
+        for (uint16_t i = 0; i < grid->length; ++i) {
+            maxTile = grid->cells[i] > maxTile ? grid->cells[i] : maxTile;
+        }
+        grid->maxTile = maxTile;
+    }
+    // The old tile may have been part of the only pair, the new one may
+    // start one
+    if (old != 0 && grid->hasPair == 1) {
+        grid->hasPair = -1;
+    }
+    if (value != 0 && grid->hasPair == 0 && HasEqualNeighbor(grid, index)) {
+        grid->hasPair = 1;
+    }
+}
+
+bool GridHasPair(Grid grid) {
+    if (grid->hasPair >= 0) {
+        return grid->hasPair;
+    }
+    uint16_t size = grid->size;
+    const uint64_t * cells = grid->cells;
+    bool found = false;
+    // Compare every cell with its right and bottom neighbors, row by row
+    for (uint16_t y = 0; y < size && !found; ++y) {
+        const uint64_t * row = cells + (size_t) y * size;
+        const uint64_t * below = y + 1 < size ? row + size : NULL;
+        for (uint16_t x = 0; x < size; ++x) {
+            if (row[x] == 0) {
+                continue;
+            }
+            if ((x + 1 < size && row[x] == row[x + 1]) ||
+                (below && row[x] == below[x])) {
+                found = true;
+                break;
+            }
+        }
+    }
+    grid->hasPair = found;
+    return found;
 }
 
 bool GridCellAvailable(Grid grid, uint64_t index) {
@@ -14,30 +134,50 @@ bool GridCellAvailable(Grid grid, uint64_t index) {
 }
 
 bool GridAnyCellAvailable(Grid grid) {
-    uint64_t index;
-    for (index = 0; index < grid->length; ++index) {
-        if (GridCellAvailable(grid, index)) {
-            return true;
-        }
-    }
-    return false;
+    return grid->n_empty > 0;
 }
 
 uint64_t GridGetAvailableCells(Grid grid, uint16_t * array, uint16_t size) {
     uint64_t count = 0;
-    uint16_t index;
-    for (index = 0; index < grid->length; ++index) {
-        if (GridCellAvailable(grid, index)) {
-            array[count++] = index;
+    if (size == 0) {
+        return 0;
+    }
+    for (size_t w = 0; w < GRID_EMPTY_WORDS(grid->length); ++w) {
+        for (uint64_t word = grid->empty[w]; word; word &= word - 1) {
+            array[count++] = w * 64 + __builtin_ctzll(word);
             if (count == size) {
-                break; // prevent buffer overflow
+                return count; // prevent buffer overflow
             }
         }
     }
     return count;
 }
 
+uint16_t GridCountAvailableCells(Grid grid) {
+    return grid->n_empty;
+}
+
+uint16_t GridGetNthAvailableCell(Grid grid, uint16_t n) {
+    size_t last = GRID_EMPTY_WORDS(grid->length) - 1;
+    size_t w = 0;
+    // Skip the words before the one holding the cell, the last one is only
+    // searched
+    for (; w < last; ++w) {
+        uint16_t count = __builtin_popcountll(grid->empty[w]);
+        if (n < count) {
+            break;
+        }
+        n -= count;
+    }
+    uint64_t word = grid->empty[w];
+    while (n--) {
+        word &= word - 1;
+    }
+    return word ? w * 64 + __builtin_ctzll(word) : grid->length;
+}
+
 void GridFree(Grid * grid) {
+    free((*grid)->empty);
     free((*grid)->cells);
     free(*grid);
     *grid = NULL;
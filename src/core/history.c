@@ -0,0 +1,131 @@
+#include "core/history.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INTERVAL HISTORY_KEYFRAME_INTERVAL
+
+// Slot of the keyframe at or before a state
+static inline uint32_t KeyframeSlot(History history, uint64_t state) {
+  return state / INTERVAL % history->n_keyframes;
+}
+
+bool HistoryInit(History *history, uint16_t length, uint32_t capacity) {
+  *history = malloc(sizeof(struct History));
+  if (!*history) {
+    return false;
+  }
+  History h = *history;
+  h->length = length;
+  h->capacity = (capacity + INTERVAL - 1) / INTERVAL * INTERVAL;
+  if (h->capacity == 0) {
+    h->capacity = INTERVAL;
+  }
+  // A keyframe for every interval of the buffer and one for the end
+  h->n_keyframes = h->capacity / INTERVAL + 1;
+  h->deltas = malloc(h->capacity * sizeof(HistoryDelta));
+  h->keyframeState = malloc(h->n_keyframes * sizeof(uint64_t));
+  h->keyframeScore = malloc(h->n_keyframes * sizeof(uint64_t));
+  h->keyframeMoves = malloc(h->n_keyframes * sizeof(uint32_t));
+  h->keyframeCells = malloc((size_t)h->n_keyframes * length * sizeof(uint64_t));
+  if (!h->deltas || !h->keyframeState || !h->keyframeScore ||
+      !h->keyframeMoves || !h->keyframeCells) {
+    HistoryFree(history);
+    return false;
+  }
+  HistoryClear(h);
+  return true;
+}
+
+void HistoryClear(History history) {
+  history->first = 0;
+  history->position = 0;
+  history->end = 0;
+  for (uint32_t k = 0; k < history->n_keyframes; ++k) {
+    history->keyframeState[k] = UINT64_MAX;
+  }
+}
+
+void HistoryCheckpoint(History history, const uint64_t *cells, uint64_t score,
+                       uint32_t moves) {
+  uint64_t state = history->position;
+  uint32_t slot = KeyframeSlot(history, state);
+  if (state % INTERVAL != 0 || history->keyframeState[slot] == state) {
+    return;
+  }
+  history->keyframeState[slot] = state;
+  history->keyframeScore[slot] = score;
+  history->keyframeMoves[slot] = moves;
+  memcpy(history->keyframeCells + (size_t)slot * history->length, cells,
+         history->length * sizeof(uint64_t));
+}
+
+// Start a new delta from the current state
+static HistoryDelta *Append(History history) {
+  // States after the current one belong to another line of play, so do
+  // their keyframes
+  for (uint64_t state = (history->position / INTERVAL + 1) * INTERVAL;
+       state <= history->end; state += INTERVAL) {
+    history->keyframeState[KeyframeSlot(history, state)] = UINT64_MAX;
+  }
+  history->end = history->position;
+  if (history->end - history->first == history->capacity) {
+    history->first += INTERVAL;
+  }
+  HistoryDelta *delta = &history->deltas[history->end % history->capacity];
+  ++history->end;
+  ++history->position;
+  return delta;
+}
+
+void HistoryRecordMove(History history, uint8_t direction) {
+  *Append(history) = (HistoryDelta){0, direction, 0};
+}
+
+void HistoryRecordSpawn(History history, uint16_t index, uint8_t exponent) {
+  HistoryDelta *delta = NULL;
+  if (history->position > history->first &&
+      history->position == history->end) {
+    delta = &history->deltas[(history->position - 1) % history->capacity];
+    if (delta->direction == HISTORY_NO_MOVE || delta->spawnExponent != 0) {
+      delta = NULL;
+    }
+  }
+  if (!delta) {
+    delta = Append(history);
+    delta->direction = HISTORY_NO_MOVE;
+  } else if (history->keyframeState[KeyframeSlot(history, history->position)] ==
+             history->position) {
+    // Saved between the move and its spawn, the keyframe lacks the tile
+    history->keyframeState[KeyframeSlot(history, history->position)] =
+        UINT64_MAX;
+  }
+  delta->spawnIndex = index;
+  delta->spawnExponent = exponent;
+}
+
+const HistoryDelta *HistoryDeltaAt(History history, uint64_t state) {
+  return &history->deltas[state % history->capacity];
+}
+
+uint64_t HistoryRestoreKeyframe(History history, uint64_t state,
+                                uint64_t *cells, uint64_t *score,
+                                uint32_t *moves) {
+  uint32_t slot = KeyframeSlot(history, state);
+  *score = history->keyframeScore[slot];
+  *moves = history->keyframeMoves[slot];
+  memcpy(cells, history->keyframeCells + (size_t)slot * history->length,
+         history->length * sizeof(uint64_t));
+  return history->keyframeState[slot];
+}
+
+void HistoryFree(History *history) {
+  free((*history)->deltas);
+  free((*history)->keyframeState);
+  free((*history)->keyframeScore);
+  free((*history)->keyframeMoves);
+  free((*history)->keyframeCells);
+  free(*history);
+  *history = NULL;
+}
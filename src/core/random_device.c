@@ -1,5 +1,7 @@
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "random.h"
 #include "random_device.h"
@@ -10,18 +12,59 @@
 #include <stdbool.h>
 
 #include <assert.h>
-#include <string.h>
 
 #include <fcntl.h>
 #include <unistd.h>
 
+#if defined(__linux__) && defined(__GLIBC__) &&                               \
+    (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 25))
+#include <sys/random.h>
+#define HAVE_GETRANDOM 1
+#endif
+
 struct RandomDevice {
   int fd;
 };
 
 size_t random_device_read(random_device_t *instance, void *buffer,
                           size_t count) {
-  return read(instance->fd, buffer, count);
+  // read() may return fewer bytes than asked, or fail with EINTR when a
+  // signal arrives: keep reading until the buffer is full
+  size_t total = 0;
+  while (total < count) {
+    ssize_t result = read(instance->fd, (char *)buffer + total, count - total);
+    if (result > 0) {
+      total += result;
+    } else if (result == -1 && errno == EINTR) {
+      continue;
+    } else {
+      break;
+    }
+  }
+  return total;
+}
+
+/**
+ * Read `count` random bytes with getrandom(2) when available, from the
+ * device otherwise, or for the bytes getrandom(2) failed to give
+ */
+static bool random_device_read_all(random_device_t *instance, void *buffer,
+                                   size_t count) {
+  size_t total = 0;
+#ifdef HAVE_GETRANDOM
+  while (total < count) {
+    ssize_t result = getrandom((char *)buffer + total, count - total, 0);
+    if (result > 0) {
+      total += result;
+    } else if (result == -1 && errno == EINTR) {
+      continue;
+    } else {
+      break; // ENOSYS on kernels older than 3.17
+    }
+  }
+#endif
+  return random_device_read(instance, (char *)buffer + total,
+                            count - total) == count - total;
 }
 
 void random_device_dtor(random_device_t *instance) {
@@ -98,11 +141,16 @@ random_device_t *random_device_ctor_token(const char *token) {
 size_t random_device_read(random_device_t *instance, void *buffer,
                           size_t count) {
   if (!CryptGenRandom(instance->hCryptProv, count, buffer)) {
-    return -1;
+    return 0;
   }
   return count;
 }
 
+static bool random_device_read_all(random_device_t *instance, void *buffer,
+                                   size_t count) {
+  return random_device_read(instance, buffer, count) == count;
+}
+
 void random_device_dtor(random_device_t *instance) {
   CryptReleaseContext(instance->hCryptProv, 0);
   free(instance);
@@ -130,16 +178,141 @@ void random_device_engine_dtor(random_engine_t *engine) {
   random_device_dtor(rd);
 }
 
+/**
+ * Fill `count` bytes from the device, or exit: never serve predictable
+ * numbers
+ */
+static void random_device_fill_or_exit(random_device_t *instance, void *out,
+                                       size_t count, const char *engine) {
+  if (!random_device_read_all(instance, out, count)) {
+    fprintf(stderr, "%s: read failed: %s\n", engine, strerror(errno));
+    exit(1);
+  }
+}
+
 uint64_t random_device_engine_next(random_engine_t *engine) {
   uint64_t result;
   random_device_t *instance = random_engine_data(engine);
-  random_device_read_s(instance, &result, sizeof(result), sizeof(result));
+  random_device_fill_or_exit(instance, &result, sizeof(result),
+                             "random_device_engine");
   return result;
 }
 
+void random_device_engine_fill(random_engine_t *engine, uint64_t *out,
+                               size_t n) {
+  // A single read for the whole batch, as many calls as it takes to fill it
+  random_device_t *instance = random_engine_data(engine);
+  random_device_fill_or_exit(instance, out, n * sizeof(uint64_t),
+                             "random_device_engine");
+}
+
 const struct RandomEngineSpec RandomDeviceEngine = {
     .name = "RandomDevice",
     .ctor = random_device_engine_ctor,
     .dtor = random_device_engine_dtor,
     .next = random_device_engine_next,
+    .fill = random_device_engine_fill,
+};
+
+/* Buffered random device engine */
+
+typedef struct RandomDeviceBuffer {
+  random_device_t *rd;
+  size_t size;     ///< Size of the block, a multiple of 8 bytes
+  size_t position; ///< First byte of the block not served yet
+  unsigned char block[];
+} random_device_buffer_t;
+
+static void random_device_buffer_refill(random_device_buffer_t *buffer,
+                                        void *out, size_t count) {
+  random_device_fill_or_exit(buffer->rd, out, count,
+                             "random_device_buffered_engine");
+}
+
+random_engine_t *random_device_buffered_engine_ctor_size(size_t size) {
+  size = size < sizeof(uint64_t) ? sizeof(uint64_t)
+                                  : size / sizeof(uint64_t) * sizeof(uint64_t);
+  random_device_buffer_t *buffer =
+      malloc(sizeof(random_device_buffer_t) + size);
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer->rd = random_device_ctor();
+  if (buffer->rd == NULL) {
+    free(buffer);
+    return NULL;
+  }
+  buffer->size = size;
+  buffer->position = size; // filled on first use
+  return random_engine_ctor((random_engine_spec_t)&RandomDeviceBufferedEngine,
+                            buffer);
+}
+
+random_engine_t *random_device_buffered_engine_ctor(void) {
+  return random_device_buffered_engine_ctor_size(
+      RANDOM_DEVICE_BUFFERED_ENGINE_BLOCK_SIZE);
+}
+
+uint64_t random_device_buffered_engine_next(random_engine_t *engine) {
+  random_device_buffer_t *buffer = random_engine_data(engine);
+  if (buffer->position == buffer->size) {
+    random_device_buffer_refill(buffer, buffer->block, buffer->size);
+    buffer->position = 0;
+  }
+  uint64_t result;
+  memcpy(&result, buffer->block + buffer->position, sizeof(result));
+  buffer->position += sizeof(result);
+  return result;
+}
+
+void random_device_buffered_engine_fill(random_engine_t *engine, uint64_t *out,
+                                        size_t n) {
+  random_device_buffer_t *buffer = random_engine_data(engine);
+  unsigned char *bytes = (unsigned char *)out;
+  size_t count = n * sizeof(uint64_t);
+
+  // Serve what is left in the block first
+  size_t available = buffer->size - buffer->position;
+  size_t served = count < available ? count : available;
+  memcpy(bytes, buffer->block + buffer->position, served);
+  buffer->position += served;
+  bytes += served;
+  count -= served;
+  if (count == 0) {
+    return;
+  }
+
+  // Requests larger than a block bypass it
+  if (count >= buffer->size) {
+    random_device_buffer_refill(buffer, bytes, count);
+    return;
+  }
+  random_device_buffer_refill(buffer, buffer->block, buffer->size);
+  memcpy(bytes, buffer->block, count);
+  buffer->position = count;
+}
+
+// Zero memory about to be freed. Stores through a volatile pointer cannot be
+// removed as dead, unlike a memset() before free()
+static void random_device_wipe(void *memory, size_t size) {
+  volatile unsigned char *bytes = memory;
+  while (size--) {
+    *bytes++ = 0;
+  }
+}
+
+void random_device_buffered_engine_dtor(random_engine_t *engine) {
+  random_device_buffer_t *buffer = random_engine_data(engine);
+  // The served numbers should not linger in memory
+  random_device_wipe(buffer->block, buffer->size);
+  random_device_dtor(buffer->rd);
+  free(buffer);
+}
+
+const struct RandomEngineSpec RandomDeviceBufferedEngine = {
+    .name = "RandomDeviceBuffered",
+    .ctor = random_device_buffered_engine_ctor,
+    .dtor = random_device_buffered_engine_dtor,
+    .next = random_device_buffered_engine_next,
+    .fill = random_device_buffered_engine_fill,
 };
@@ -27,3 +27,15 @@ uint64_t random_engine_next(random_engine_t * engine) {
     random_engine_next_fn next = engine->spec->next;
     return next(engine);
 }
+
+void random_engine_fill(random_engine_t * engine, uint64_t * out, size_t n) {
+    random_engine_fill_fn fill = engine->spec->fill;
+    if (fill) {
+        fill(engine, out, n);
+        return;
+    }
+    random_engine_next_fn next = engine->spec->next;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = next(engine);
+    }
+}
@@ -0,0 +1,491 @@
+#include "core/replay.h"
+#include "random.h"
+#include "xoshiro256ss.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAGIC_LENGTH (sizeof(REPLAY_MAGIC) - 1)
+// Bytes of a varint of 64 bits at most
+#define VARINT_MAX 10
+// Bytes of an encoded state, besides its cells
+#define STATE_OVERHEAD (2 * VARINT_MAX + 4 * sizeof(uint64_t))
+
+static size_t PutVarint(uint8_t *out, uint64_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+static bool GetVarint(const uint8_t *data, size_t size, size_t *offset,
+                      uint64_t *value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && *offset < size; shift += 7) {
+    uint8_t byte = data[(*offset)++];
+    *value |= (uint64_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static size_t PutUint64(uint8_t *out, uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    out[i] = (uint8_t)(value >> (8 * i));
+  }
+  return 8;
+}
+
+static uint64_t GetUint64(const uint8_t *data) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value |= (uint64_t)data[i] << (8 * i);
+  }
+  return value;
+}
+
+static size_t EncodeState(Game game, uint8_t *out) {
+  size_t n = PutVarint(out, game->score);
+  n += PutVarint(out + n, game->moves);
+  for (int w = 0; w < 4; ++w) {
+    n += PutUint64(out + n, game->rng.state[w]);
+  }
+  for (uint16_t i = 0; i < game->grid->length; ++i) {
+    uint64_t cell = game->grid->cells[i];
+    out[n++] = cell ? __builtin_ctzll(cell) : 0;
+  }
+  return n;
+}
+
+// Decode a state of a grid of `length` cells, false if it is truncated or a
+// tile does not fit
+static bool DecodeState(const uint8_t *data, size_t size, size_t *offset,
+                        uint16_t length, uint64_t *score, uint64_t *moves,
+                        xoshiro256ss_t *rng, uint64_t *cells) {
+  if (!GetVarint(data, size, offset, score) ||
+      !GetVarint(data, size, offset, moves) ||
+      size - *offset < 4 * sizeof(uint64_t) + length) {
+    return false;
+  }
+  for (int w = 0; w < 4; ++w) {
+    rng->state[w] = GetUint64(data + *offset);
+    *offset += 8;
+  }
+  for (uint16_t i = 0; i < length; ++i) {
+    uint8_t exponent = data[(*offset)++];
+    if (exponent >= 64) {
+      return false;
+    }
+    cells[i] = exponent ? (uint64_t)1 << exponent : 0;
+  }
+  return true;
+}
+
+/* Recorder */
+
+static void Write(ReplayRecorder recorder, const void *bytes, size_t n) {
+  if (fwrite(bytes, 1, n, recorder->stream) != n) {
+    recorder->failed = true;
+  }
+}
+
+static void WriteHeader(ReplayRecorder recorder, uint64_t header) {
+  uint8_t bytes[VARINT_MAX];
+  Write(recorder, bytes, PutVarint(bytes, header));
+}
+
+// Write the record buffered
+static void FlushRun(ReplayRecorder recorder) {
+  if (recorder->count == 0) {
+    return;
+  }
+  WriteHeader(recorder, (uint64_t)recorder->count << 3 | recorder->kind);
+  if (recorder->kind != REPLAY_SPAWNS) {
+    Write(recorder, recorder->run, (recorder->count + 3) / 4);
+    memset(recorder->run, 0, sizeof(recorder->run));
+  }
+  recorder->count = 0;
+}
+
+// Add a move or a spawn to the record buffered, starting a new one if the
+// kind differs
+static void Append(ReplayRecorder recorder, ReplayKind kind,
+                   uint8_t direction) {
+  if (recorder->kind != kind) {
+    FlushRun(recorder);
+    recorder->kind = kind;
+  }
+  if (kind != REPLAY_SPAWNS) {
+    recorder->run[recorder->count / 4] |= direction << (recorder->count % 4 * 2);
+  }
+  if (++recorder->count == REPLAY_RUN_BYTES * 4) {
+    FlushRun(recorder);
+  }
+}
+
+// A move still waiting for its spawn goes without
+static void AppendPending(ReplayRecorder recorder) {
+  if (recorder->pending >= 0) {
+    Append(recorder, REPLAY_MOVES, recorder->pending);
+    recorder->pending = -1;
+  }
+}
+
+static void WriteState(ReplayRecorder recorder, ReplayKind kind, Game game) {
+  AppendPending(recorder);
+  FlushRun(recorder);
+  WriteHeader(recorder, kind);
+  uint8_t played[VARINT_MAX];
+  Write(recorder, played, PutVarint(played, recorder->played));
+  Write(recorder, recorder->state, EncodeState(game, recorder->state));
+  recorder->keyframe = recorder->played;
+}
+
+bool ReplayRecorderInit(ReplayRecorder *recorder, Game game, FILE *stream) {
+  *recorder = NULL;
+  if (game->re) {
+    return false;
+  }
+  ReplayRecorder result = calloc(1, sizeof(struct ReplayRecorder));
+  if (!result) {
+    return false;
+  }
+  result->state = malloc(STATE_OVERHEAD + game->grid->length);
+  if (!result->state) {
+    free(result);
+    return false;
+  }
+  result->stream = stream;
+  result->pending = -1;
+
+  const char *name = Xoshiro256ssEngine.name;
+  uint8_t header[MAGIC_LENGTH + 3];
+  memcpy(header, REPLAY_MAGIC, MAGIC_LENGTH);
+  header[MAGIC_LENGTH] = REPLAY_VERSION;
+  header[MAGIC_LENGTH + 1] = game->grid->size;
+  header[MAGIC_LENGTH + 2] = (uint8_t)strlen(name);
+  Write(result, header, sizeof(header));
+  Write(result, name, strlen(name));
+  Write(result, result->state, EncodeState(game, result->state));
+  if (result->failed) {
+    ReplayRecorderFree(&result);
+    return false;
+  }
+  *recorder = result;
+  return true;
+}
+
+void ReplayRecorderCheckpoint(ReplayRecorder recorder, Game game) {
+  if (recorder->played % REPLAY_KEYFRAME_INTERVAL == 0 &&
+      recorder->played != recorder->keyframe) {
+    WriteState(recorder, REPLAY_KEYFRAME, game);
+  }
+}
+
+void ReplayRecordMove(ReplayRecorder recorder, Direction direction) {
+  AppendPending(recorder);
+  recorder->pending = direction;
+  ++recorder->played;
+}
+
+void ReplayRecordSpawn(ReplayRecorder recorder) {
+  if (recorder->pending >= 0) {
+    Append(recorder, REPLAY_MOVES_SPAWNS, recorder->pending);
+    recorder->pending = -1;
+  } else {
+    Append(recorder, REPLAY_SPAWNS, 0);
+  }
+}
+
+void ReplayRecordState(ReplayRecorder recorder, Game game) {
+  WriteState(recorder, REPLAY_STATE, game);
+}
+
+bool ReplayRecorderFlush(ReplayRecorder recorder) {
+  // Replayed alone, a move and its spawn give the same state
+  AppendPending(recorder);
+  FlushRun(recorder);
+  if (fflush(recorder->stream) != 0) {
+    recorder->failed = true;
+  }
+  return !recorder->failed;
+}
+
+bool ReplayRecorderFree(ReplayRecorder *recorder) {
+  bool flushed = ReplayRecorderFlush(*recorder);
+  free((*recorder)->state);
+  free(*recorder);
+  *recorder = NULL;
+  return flushed;
+}
+
+/* Player */
+
+// Decode the state at `*offset` into the game
+static bool LoadState(ReplayPlayer player, size_t *offset) {
+  Game game = player->game;
+  uint64_t moves;
+  if (!DecodeState(player->data, player->size, offset, game->grid->length,
+                   &game->score, &moves, &game->rng, game->grid->cells)) {
+    return false;
+  }
+  GridSync(game->grid);
+  game->moves = (uint32_t)moves;
+  return true;
+}
+
+// Whether the game is in the state at `*offset`. The moves are not compared,
+// they are counted by the caller.
+static bool CheckState(ReplayPlayer player, size_t *offset) {
+  Game game = player->game;
+  uint64_t score, moves;
+  xoshiro256ss_t rng;
+  uint16_t length = game->grid->length;
+  uint64_t *cells = malloc(length * sizeof(uint64_t));
+  bool same = cells &&
+              DecodeState(player->data, player->size, offset, length, &score,
+                          &moves, &rng, cells) &&
+              score == game->score &&
+              memcmp(&rng, &game->rng, sizeof(rng)) == 0 &&
+              memcmp(cells, game->grid->cells, length * sizeof(uint64_t)) == 0;
+  free(cells);
+  return same;
+}
+
+static bool AddSeek(ReplayPlayer player, uint64_t moves, size_t offset) {
+  // Grown by powers of two
+  if ((player->n_seeks & (player->n_seeks - 1)) == 0) {
+    size_t capacity = player->n_seeks ? 2 * player->n_seeks : 1;
+    uint64_t *seekMoves =
+        realloc(player->seekMoves, capacity * sizeof(uint64_t));
+    if (!seekMoves) {
+      return false;
+    }
+    player->seekMoves = seekMoves;
+    size_t *seekOffsets =
+        realloc(player->seekOffsets, capacity * sizeof(size_t));
+    if (!seekOffsets) {
+      return false;
+    }
+    player->seekOffsets = seekOffsets;
+  }
+  player->seekMoves[player->n_seeks] = moves;
+  player->seekOffsets[player->n_seeks] = offset;
+  ++player->n_seeks;
+  return true;
+}
+
+// Check the framing of every record, count the moves and list the states to
+// seek from
+static bool Scan(ReplayPlayer player, size_t offset) {
+  const uint8_t *data = player->data;
+  size_t size = player->size;
+  uint16_t length = player->game->grid->length;
+  uint64_t *cells = malloc(length * sizeof(uint64_t));
+  uint64_t played = 0;
+  bool valid = cells != NULL;
+  while (valid && offset < size) {
+    uint64_t header, moves, score;
+    xoshiro256ss_t rng;
+    if (!GetVarint(data, size, &offset, &header)) {
+      valid = false;
+      break;
+    }
+    uint64_t count = header >> 3;
+    switch (header & 7) {
+    case REPLAY_MOVES_SPAWNS:
+    case REPLAY_MOVES:
+      if (count > UINT32_MAX || (count + 3) / 4 > size - offset) {
+        valid = false;
+        break;
+      }
+      offset += (count + 3) / 4;
+      played += count;
+      break;
+    case REPLAY_SPAWNS:
+      valid = count <= UINT32_MAX;
+      break;
+    case REPLAY_KEYFRAME:
+    case REPLAY_STATE:
+      valid = GetVarint(data, size, &offset, &moves) && moves == played &&
+              AddSeek(player, played, offset) &&
+              DecodeState(data, size, &offset, length, &score, &moves, &rng,
+                          cells);
+      break;
+    default:
+      valid = false;
+    }
+  }
+  free(cells);
+  player->n_moves = played;
+  return valid;
+}
+
+bool ReplayPlayerInit(ReplayPlayer *player, const void *data, size_t size) {
+  *player = NULL;
+  const uint8_t *bytes = data;
+  const char *name = Xoshiro256ssEngine.name;
+  size_t nameLength = strlen(name);
+  size_t header = MAGIC_LENGTH + 3 + nameLength;
+  if (size < header || memcmp(bytes, REPLAY_MAGIC, MAGIC_LENGTH) != 0 ||
+      bytes[MAGIC_LENGTH] != REPLAY_VERSION || bytes[MAGIC_LENGTH + 1] == 0 ||
+      bytes[MAGIC_LENGTH + 2] != nameLength ||
+      memcmp(bytes + MAGIC_LENGTH + 3, name, nameLength) != 0) {
+    return false;
+  }
+  ReplayPlayer result = calloc(1, sizeof(struct ReplayPlayer));
+  if (!result) {
+    return false;
+  }
+  result->data = malloc(size);
+  if (!result->data) {
+    free(result);
+    return false;
+  }
+  memcpy(result->data, data, size);
+  result->size = size;
+  GameInitWithSeed(&result->game, bytes[MAGIC_LENGTH + 1], 0);
+  size_t offset = header;
+  if (!AddSeek(result, 0, offset) || !LoadState(result, &offset) ||
+      !Scan(result, offset)) {
+    ReplayPlayerFree(&result);
+    return false;
+  }
+  result->cursor = offset;
+  *player = result;
+  return true;
+}
+
+bool ReplayPlayerLoad(ReplayPlayer *player, FILE *stream) {
+  size_t size = 0, capacity = 4096;
+  uint8_t *data = malloc(capacity);
+  size_t n;
+  while (data && (n = fread(data + size, 1, capacity - size, stream)) > 0) {
+    size += n;
+    if (size == capacity) {
+      capacity *= 2;
+      uint8_t *grown = realloc(data, capacity);
+      if (!grown) {
+        free(data);
+      }
+      data = grown;
+    }
+  }
+  bool loaded = data && !ferror(stream) && ReplayPlayerInit(player, data, size);
+  free(data);
+  if (!loaded) {
+    *player = NULL;
+  }
+  return loaded;
+}
+
+static bool Fail(ReplayPlayer player) {
+  player->failed = true;
+  return false;
+}
+
+bool ReplayPlayerStep(ReplayPlayer player) {
+  if (player->failed) {
+    return false;
+  }
+  Game game = player->game;
+  while (player->remaining == 0) {
+    if (player->cursor == player->size) {
+      return false;
+    }
+    // Records were checked when the replay was opened
+    uint64_t header, moves;
+    GetVarint(player->data, player->size, &player->cursor, &header);
+    player->kind = header & 7;
+    if (player->kind == REPLAY_KEYFRAME || player->kind == REPLAY_STATE) {
+      GetVarint(player->data, player->size, &player->cursor, &moves);
+      if (player->kind == REPLAY_STATE) {
+        return LoadState(player, &player->cursor);
+      }
+      if (!CheckState(player, &player->cursor)) {
+        return Fail(player);
+      }
+      continue;
+    }
+    player->remaining = header >> 3;
+    player->directions = player->cursor;
+    player->shift = 0;
+    if (player->kind != REPLAY_SPAWNS) {
+      player->cursor += (player->remaining + 3) / 4;
+    }
+  }
+
+  --player->remaining;
+  if (player->kind != REPLAY_SPAWNS) {
+    Direction direction =
+        (player->data[player->directions] >> player->shift) & 3;
+    player->shift += 2;
+    if (player->shift == 8) {
+      player->shift = 0;
+      ++player->directions;
+    }
+    if (!GameMove(game, direction, NULL)) {
+      return Fail(player);
+    }
+    ++game->moves;
+    ++player->played;
+  }
+  if (player->kind != REPLAY_MOVES && GameAddRandomTile(game) < 0) {
+    return Fail(player);
+  }
+  return true;
+}
+
+bool ReplayPlayerRun(ReplayPlayer player) {
+  while (ReplayPlayerStep(player)) {
+  }
+  return !player->failed;
+}
+
+bool ReplayPlayerSeek(ReplayPlayer player, uint64_t move) {
+  if (move > player->n_moves) {
+    return false;
+  }
+  // Last state to seek from at or before the move
+  uint32_t low = 0, high = player->n_seeks;
+  while (high - low > 1) {
+    uint32_t middle = low + (high - low) / 2;
+    if (player->seekMoves[middle] <= move) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  // Carry on from the current state if it is closer
+  if (player->failed || player->played > move ||
+      player->played < player->seekMoves[low]) {
+    size_t offset = player->seekOffsets[low];
+    LoadState(player, &offset);
+    player->cursor = offset;
+    player->played = player->seekMoves[low];
+    player->remaining = 0;
+    player->failed = false;
+  }
+  while (player->played < move) {
+    if (!ReplayPlayerStep(player)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ReplayPlayerFree(ReplayPlayer *player) {
+  GameFree(&(*player)->game);
+  free((*player)->seekMoves);
+  free((*player)->seekOffsets);
+  free((*player)->data);
+  free(*player);
+  *player = NULL;
+}
@@ -0,0 +1,491 @@
+#include "core/row_kernel.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ROW_KERNEL_X86 1
+#include <immintrin.h>
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__aarch64__)
+#define ROW_KERNEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Shuffle tables packing the non-empty lanes of a vector to its front: entry
+// `mask` gives, for every output lane, the input lane of the `p`-th bit set
+// in `mask`, or 0x80 once all of them are placed. Both `pshufb` and `tbl`
+// write 0 for such an index. Written as constant expressions.
+#define BIT(m, l) (((m) >> (l)) & 1)
+#define POP8(m)                                                               \
+  (BIT(m, 0) + BIT(m, 1) + BIT(m, 2) + BIT(m, 3) + BIT(m, 4) + BIT(m, 5) +    \
+   BIT(m, 6) + BIT(m, 7))
+#define BELOW(m, l) POP8((m) & ((1u << (l)) - 1))
+#define SOURCE_TERM(m, p, l) ((BIT(m, l) && BELOW(m, l) == (p)) ? (l) : 0)
+#define SOURCE(m, p)                                                          \
+  (POP8(m) > (p) ? SOURCE_TERM(m, p, 0) + SOURCE_TERM(m, p, 1) +              \
+                       SOURCE_TERM(m, p, 2) + SOURCE_TERM(m, p, 3) +          \
+                       SOURCE_TERM(m, p, 4) + SOURCE_TERM(m, p, 5) +          \
+                       SOURCE_TERM(m, p, 6) + SOURCE_TERM(m, p, 7)            \
+                 : 0x80)
+
+#define COMPRESS8_ENTRY(m)                                                    \
+  {                                                                           \
+    SOURCE(m, 0), SOURCE(m, 1), SOURCE(m, 2), SOURCE(m, 3), SOURCE(m, 4),     \
+        SOURCE(m, 5), SOURCE(m, 6), SOURCE(m, 7)                              \
+  }
+#define COMPRESS8_ENTRIES(m)                                                  \
+  COMPRESS8_ENTRY(m), COMPRESS8_ENTRY(m + 1), COMPRESS8_ENTRY(m + 2),         \
+      COMPRESS8_ENTRY(m + 3), COMPRESS8_ENTRY(m + 4), COMPRESS8_ENTRY(m + 5), \
+      COMPRESS8_ENTRY(m + 6), COMPRESS8_ENTRY(m + 7), COMPRESS8_ENTRY(m + 8), \
+      COMPRESS8_ENTRY(m + 9), COMPRESS8_ENTRY(m + 10),                        \
+      COMPRESS8_ENTRY(m + 11), COMPRESS8_ENTRY(m + 12),                       \
+      COMPRESS8_ENTRY(m + 13), COMPRESS8_ENTRY(m + 14),                       \
+      COMPRESS8_ENTRY(m + 15)
+
+// Packs 8 lanes of 8 bits
+static const uint8_t COMPRESS8[256][8] __attribute__((unused)) = {
+    COMPRESS8_ENTRIES(0),   COMPRESS8_ENTRIES(16),  COMPRESS8_ENTRIES(32),
+    COMPRESS8_ENTRIES(48),  COMPRESS8_ENTRIES(64),  COMPRESS8_ENTRIES(80),
+    COMPRESS8_ENTRIES(96),  COMPRESS8_ENTRIES(112), COMPRESS8_ENTRIES(128),
+    COMPRESS8_ENTRIES(144), COMPRESS8_ENTRIES(160), COMPRESS8_ENTRIES(176),
+    COMPRESS8_ENTRIES(192), COMPRESS8_ENTRIES(208), COMPRESS8_ENTRIES(224),
+    COMPRESS8_ENTRIES(240),
+};
+
+// Packs 4 lanes of 64 bits, as pairs of 32 bits lanes for `vpermd`. Unused
+// lanes repeat the first lane.
+#define LANE64(m, p) (SOURCE(m, p) & 3)
+#define COMPRESS64_ENTRY(m)                                                   \
+  {                                                                           \
+    2 * LANE64(m, 0), 2 * LANE64(m, 0) + 1, 2 * LANE64(m, 1),                 \
+        2 * LANE64(m, 1) + 1, 2 * LANE64(m, 2), 2 * LANE64(m, 2) + 1,         \
+        2 * LANE64(m, 3), 2 * LANE64(m, 3) + 1                                \
+  }
+
+static const uint32_t COMPRESS64[16][8] __attribute__((unused)) = {
+    COMPRESS64_ENTRY(0),  COMPRESS64_ENTRY(1),  COMPRESS64_ENTRY(2),
+    COMPRESS64_ENTRY(3),  COMPRESS64_ENTRY(4),  COMPRESS64_ENTRY(5),
+    COMPRESS64_ENTRY(6),  COMPRESS64_ENTRY(7),  COMPRESS64_ENTRY(8),
+    COMPRESS64_ENTRY(9),  COMPRESS64_ENTRY(10), COMPRESS64_ENTRY(11),
+    COMPRESS64_ENTRY(12), COMPRESS64_ENTRY(13), COMPRESS64_ENTRY(14),
+    COMPRESS64_ENTRY(15),
+};
+
+static inline uint64_t ExponentValue(uint8_t exponent) {
+  return exponent < 64 ? (uint64_t)1 << exponent : 0;
+}
+
+/* Scalar kernels */
+
+static bool Move64Scalar(uint64_t *row, uint16_t length, uint64_t *score) {
+  uint16_t target = 0;    // position of the next placed tile
+  bool mergeable = false; // whether the last placed tile can still merge
+  bool moved = false;
+  for (uint16_t x = 0; x < length; ++x) {
+    uint64_t value = row[x];
+    if (value == 0) {
+      continue;
+    }
+    if (mergeable && row[target - 1] == value) {
+      row[target - 1] = value << 1;
+      row[x] = 0;
+      *score += value << 1;
+      mergeable = false;
+      moved = true;
+      continue;
+    }
+    mergeable = true;
+    if (target != x) {
+      row[target] = value;
+      row[x] = 0;
+      moved = true;
+    }
+    ++target;
+  }
+  return moved;
+}
+
+static bool Move8Scalar(uint8_t *row, uint16_t length, uint64_t *score) {
+  uint16_t target = 0;
+  bool mergeable = false;
+  bool moved = false;
+  for (uint16_t x = 0; x < length; ++x) {
+    uint8_t exponent = row[x];
+    if (exponent == 0) {
+      continue;
+    }
+    if (mergeable && row[target - 1] == exponent && exponent != UINT8_MAX) {
+      row[target - 1] = exponent + 1;
+      row[x] = 0;
+      *score += ExponentValue(exponent + 1);
+      mergeable = false;
+      moved = true;
+      continue;
+    }
+    mergeable = true;
+    if (target != x) {
+      row[target] = exponent;
+      row[x] = 0;
+      moved = true;
+    }
+    ++target;
+  }
+  return moved;
+}
+
+/* Vector kernels
+ *
+ * Vector kernels move a row in three steps:
+ * - pack the tiles to the front of the row, a vector at a time, with the
+ *   shuffle tables above,
+ * - flag the pairs of equal neighbors of the packed tiles, a vector at a time,
+ *   then merge the flagged pairs from left to right, skipping the pairs whose
+ *   first tile was just merged with its left neighbor,
+ * - pack the tiles again if any pair merged.
+ *
+ * Vectors are packed in place: a vector is always stored at or before the
+ * position it was loaded from, so it only overwrites lanes already read.
+ */
+
+// Merge the pairs flagged in `pairs`, bit `i` standing for the cells
+// `base + i` and `base + i + 1`. `next` is the first cell that can still
+// merge. Returns the number of merged pairs.
+static inline uint16_t MergePairs64(uint64_t *row, uint16_t base,
+                                    uint64_t pairs, uint16_t *next,
+                                    uint64_t *score) {
+  uint16_t merges = 0;
+  while (pairs) {
+    uint16_t i = base + __builtin_ctzll(pairs);
+    pairs &= pairs - 1;
+    if (i >= *next) {
+      row[i] <<= 1;
+      row[i + 1] = 0;
+      *score += row[i];
+      *next = i + 2;
+      ++merges;
+    }
+  }
+  return merges;
+}
+
+static inline uint16_t MergePairs8(uint8_t *row, uint16_t base, uint64_t pairs,
+                                   uint16_t *next, uint64_t *score) {
+  uint16_t merges = 0;
+  while (pairs) {
+    uint16_t i = base + __builtin_ctzll(pairs);
+    pairs &= pairs - 1;
+    if (i >= *next) {
+      ++row[i];
+      row[i + 1] = 0;
+      *score += ExponentValue(row[i]);
+      *next = i + 2;
+      ++merges;
+    }
+  }
+  return merges;
+}
+
+// Flag the equal neighbors among the cells [x, count) missed by the vector
+// loop of `Pairs*`, up to the end of the 64 cells starting at `base`
+static inline uint64_t PairsTail64(const uint64_t *row, uint16_t base,
+                                   uint16_t x, uint16_t count) {
+  uint64_t pairs = 0;
+  for (; x + 1 < count && x < base + 64; ++x) {
+    pairs |= (uint64_t)(row[x] == row[x + 1]) << (x - base);
+  }
+  return pairs;
+}
+
+static inline uint64_t PairsTail8(const uint8_t *row, uint16_t base, uint16_t x,
+                                  uint16_t count) {
+  uint64_t pairs = 0;
+  for (; x + 1 < count && x < base + 64; ++x) {
+    pairs |= (uint64_t)(row[x] == row[x + 1] && row[x] != UINT8_MAX)
+             << (x - base);
+  }
+  return pairs;
+}
+
+// Finish packing with the cells [x, length) left over by the vector loop of
+// `Compact*`, then clear the cells after the packed ones
+static inline uint16_t CompactTail64(uint64_t *row, uint16_t length,
+                                     uint16_t x, uint16_t out, bool *moved) {
+  for (; x < length; ++x) {
+    if (row[x]) {
+      if (out != x) {
+        row[out] = row[x];
+        *moved = true;
+      }
+      ++out;
+    }
+  }
+  memset(row + out, 0, (length - out) * sizeof(uint64_t));
+  return out;
+}
+
+static inline uint16_t CompactTail8(uint8_t *row, uint16_t length, uint16_t x,
+                                    uint16_t out, bool *moved) {
+  for (; x < length; ++x) {
+    if (row[x]) {
+      if (out != x) {
+        row[out] = row[x];
+        *moved = true;
+      }
+      ++out;
+    }
+  }
+  memset(row + out, 0, length - out);
+  return out;
+}
+
+// Whether a vector of tiles at `x`, flagged in `mask`, has to be stored at
+// `out`: false if its tiles are already packed in place
+static inline bool NeedsStore(uint16_t out, uint16_t x, uint32_t mask,
+                              uint8_t count) {
+  return out != x || mask != (uint32_t)((1ULL << count) - 1);
+}
+
+#define DEFINE_ROW_MOVE(name, type, target, compact, pairsOf, mergePairs)     \
+  target static bool name(type *row, uint16_t length, uint64_t *score) {      \
+    bool moved = false;                                                       \
+    uint16_t count = compact(row, length, &moved);                            \
+    uint16_t merges = 0, next = 0;                                            \
+    for (uint16_t base = 0; base + 1 < count; base += 64) {                   \
+      merges += mergePairs(row, base, pairsOf(row, base, count), &next,       \
+                           score);                                            \
+    }                                                                         \
+    if (merges) {                                                             \
+      compact(row, count, &moved);                                            \
+      moved = true;                                                           \
+    }                                                                         \
+    return moved;                                                             \
+  }
+
+#ifdef ROW_KERNEL_X86
+
+/* SSE4.1: 16 lanes of 8 bits. Two lanes of 64 bits are slower than the
+ * scalar kernel, so uint64_t rows use it */
+
+// Pack the 16 lanes of `v` flagged in `mask` at `row + out`
+TARGET_SSE41 static inline uint16_t Store8Sse41(uint8_t *row, uint16_t out,
+                                                __m128i v, uint32_t mask) {
+  uint32_t low = mask & 0xFF, high = (mask >> 8) & 0xFF;
+  __m128i packed = _mm_shuffle_epi8(
+      v, _mm_loadl_epi64((const __m128i *)COMPRESS8[low]));
+  _mm_storel_epi64((__m128i *)(row + out), packed);
+  out += __builtin_popcount(low);
+  packed = _mm_shuffle_epi8(_mm_srli_si128(v, 8),
+                            _mm_loadl_epi64((const __m128i *)COMPRESS8[high]));
+  _mm_storel_epi64((__m128i *)(row + out), packed);
+  return out + __builtin_popcount(high);
+}
+
+TARGET_SSE41 static inline uint16_t Compact8Sse41(uint8_t *row,
+                                                  uint16_t length,
+                                                  bool *moved) {
+  const __m128i zero = _mm_setzero_si128();
+  uint16_t out = 0, x = 0;
+  for (; x + 16 <= length; x += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(row + x));
+    uint32_t mask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) & 0xFFFF;
+    uint8_t n = __builtin_popcount(mask);
+    if (n && NeedsStore(out, x, mask, n)) {
+      Store8Sse41(row, out, v, mask);
+      *moved = true;
+    }
+    out += n;
+  }
+  return CompactTail8(row, length, x, out, moved);
+}
+
+TARGET_SSE41 static inline uint64_t Pairs8Sse41(const uint8_t *row,
+                                                uint16_t base, uint16_t count) {
+  const __m128i max = _mm_set1_epi8((char)UINT8_MAX);
+  uint64_t pairs = 0;
+  uint16_t x = base;
+  for (; x + 17 <= count && x + 16 <= base + 64; x += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(row + x));
+    __m128i b = _mm_loadu_si128((const __m128i *)(row + x + 1));
+    __m128i equal = _mm_andnot_si128(_mm_cmpeq_epi8(a, max),
+                                     _mm_cmpeq_epi8(a, b));
+    uint64_t mask = (uint32_t)_mm_movemask_epi8(equal);
+    pairs |= mask << (x - base);
+  }
+  return pairs | PairsTail8(row, base, x, count);
+}
+
+DEFINE_ROW_MOVE(Move8Sse41, uint8_t, TARGET_SSE41, Compact8Sse41, Pairs8Sse41,
+                MergePairs8)
+
+/* AVX2: 4 lanes of 64 bits, or 32 lanes of 8 bits */
+
+TARGET_AVX2 static inline uint16_t Compact64Avx2(uint64_t *row,
+                                                 uint16_t length,
+                                                 bool *moved) {
+  const __m256i zero = _mm256_setzero_si256();
+  uint16_t out = 0, x = 0;
+  for (; x + 4 <= length; x += 4) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(row + x));
+    uint32_t mask =
+        ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, zero))) &
+        0xF;
+    uint8_t n = __builtin_popcount(mask);
+    if (n && NeedsStore(out, x, mask, n)) {
+      v = _mm256_permutevar8x32_epi32(
+          v, _mm256_loadu_si256((const __m256i *)COMPRESS64[mask]));
+      _mm256_storeu_si256((__m256i *)(row + out), v);
+      *moved = true;
+    }
+    out += n;
+  }
+  return CompactTail64(row, length, x, out, moved);
+}
+
+TARGET_AVX2 static inline uint64_t Pairs64Avx2(const uint64_t *row,
+                                               uint16_t base, uint16_t count) {
+  uint64_t pairs = 0;
+  uint16_t x = base;
+  for (; x + 5 <= count && x + 4 <= base + 64; x += 4) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(row + x));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(row + x + 1));
+    uint64_t mask =
+        _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(a, b)));
+    pairs |= mask << (x - base);
+  }
+  return pairs | PairsTail64(row, base, x, count);
+}
+
+TARGET_AVX2 static inline uint16_t Compact8Avx2(uint8_t *row, uint16_t length,
+                                                bool *moved) {
+  const __m256i zero = _mm256_setzero_si256();
+  uint16_t out = 0, x = 0;
+  for (; x + 32 <= length; x += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(row + x));
+    uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+    uint8_t n = __builtin_popcount(mask);
+    if (n && NeedsStore(out, x, mask, n)) {
+      uint16_t half = Store8Sse41(row, out, _mm256_castsi256_si128(v),
+                                  mask & 0xFFFF);
+      Store8Sse41(row, half, _mm256_extracti128_si256(v, 1), mask >> 16);
+      *moved = true;
+    }
+    out += n;
+  }
+  return CompactTail8(row, length, x, out, moved);
+}
+
+TARGET_AVX2 static inline uint64_t Pairs8Avx2(const uint8_t *row,
+                                              uint16_t base, uint16_t count) {
+  const __m256i max = _mm256_set1_epi8((char)UINT8_MAX);
+  uint64_t pairs = 0;
+  uint16_t x = base;
+  for (; x + 33 <= count && x + 32 <= base + 64; x += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(row + x));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(row + x + 1));
+    __m256i equal = _mm256_andnot_si256(_mm256_cmpeq_epi8(a, max),
+                                        _mm256_cmpeq_epi8(a, b));
+    uint64_t mask = (uint32_t)_mm256_movemask_epi8(equal);
+    pairs |= mask << (x - base);
+  }
+  return pairs | PairsTail8(row, base, x, count);
+}
+
+DEFINE_ROW_MOVE(Move64Avx2, uint64_t, TARGET_AVX2, Compact64Avx2, Pairs64Avx2,
+                MergePairs64)
+DEFINE_ROW_MOVE(Move8Avx2, uint8_t, TARGET_AVX2, Compact8Avx2, Pairs8Avx2,
+                MergePairs8)
+
+static bool SupportsSse41(void) { return __builtin_cpu_supports("sse4.1"); }
+
+static bool SupportsAvx2(void) { return __builtin_cpu_supports("avx2"); }
+
+#endif
+
+#ifdef ROW_KERNEL_NEON
+
+/* NEON: 8 lanes of 8 bits. Vectors of 2 lanes of 64 bits do not beat the
+ * scalar kernel, which is used for rows of values instead. */
+
+static const uint8_t LANE_BITS[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+
+static inline uint32_t Mask8Neon(uint8x8_t flags) {
+  return vaddv_u8(vand_u8(flags, vld1_u8(LANE_BITS)));
+}
+
+static inline uint16_t Compact8Neon(uint8_t *row, uint16_t length,
+                                    bool *moved) {
+  uint16_t out = 0, x = 0;
+  for (; x + 8 <= length; x += 8) {
+    uint8x8_t v = vld1_u8(row + x);
+    uint32_t mask = Mask8Neon(vtst_u8(v, v));
+    uint8_t n = __builtin_popcount(mask);
+    if (n && NeedsStore(out, x, mask, n)) {
+      vst1_u8(row + out, vtbl1_u8(v, vld1_u8(COMPRESS8[mask])));
+      *moved = true;
+    }
+    out += n;
+  }
+  return CompactTail8(row, length, x, out, moved);
+}
+
+static inline uint64_t Pairs8Neon(const uint8_t *row, uint16_t base,
+                                  uint16_t count) {
+  const uint8x8_t max = vdup_n_u8(UINT8_MAX);
+  uint64_t pairs = 0;
+  uint16_t x = base;
+  for (; x + 9 <= count && x + 8 <= base + 64; x += 8) {
+    uint8x8_t a = vld1_u8(row + x);
+    uint8x8_t b = vld1_u8(row + x + 1);
+    uint8x8_t equal = vbic_u8(vceq_u8(a, b), vceq_u8(a, max));
+    pairs |= (uint64_t)Mask8Neon(equal) << (x - base);
+  }
+  return pairs | PairsTail8(row, base, x, count);
+}
+
+DEFINE_ROW_MOVE(Move8Neon, uint8_t, , Compact8Neon, Pairs8Neon, MergePairs8)
+
+#endif
+
+static bool Always(void) { return true; }
+
+static bool __attribute__((unused)) Never(void) { return false; }
+
+const RowKernel RowKernelScalar = {"scalar", Always, Move64Scalar,
+                                   Move8Scalar};
+
+#ifdef ROW_KERNEL_X86
+const RowKernel RowKernelSse41 = {"sse4.1", SupportsSse41, Move64Scalar,
+                                  Move8Sse41};
+const RowKernel RowKernelAvx2 = {"avx2", SupportsAvx2, Move64Avx2, Move8Avx2};
+#else
+const RowKernel RowKernelSse41 = {"sse4.1", Never, Move64Scalar, Move8Scalar};
+const RowKernel RowKernelAvx2 = {"avx2", Never, Move64Scalar, Move8Scalar};
+#endif
+
+#ifdef ROW_KERNEL_NEON
+const RowKernel RowKernelNeon = {"neon", Always, Move64Scalar, Move8Neon};
+#else
+const RowKernel RowKernelNeon = {"neon", Never, Move64Scalar, Move8Scalar};
+#endif
+
+const RowKernel *RowKernelGet(void) {
+  static const RowKernel *const CANDIDATES[] = {
+      &RowKernelAvx2, &RowKernelSse41, &RowKernelNeon, &RowKernelScalar};
+  static _Atomic(const RowKernel *) selected = NULL;
+  const RowKernel *kernel =
+      atomic_load_explicit(&selected, memory_order_relaxed);
+  if (kernel == NULL) {
+    for (size_t i = 0; kernel == NULL; ++i) {
+      if (CANDIDATES[i]->supported()) {
+        kernel = CANDIDATES[i];
+      }
+    }
+    atomic_store_explicit(&selected, kernel, memory_order_relaxed);
+  }
+  return kernel;
+}
@@ -0,0 +1,178 @@
+#include "core/transposition.h"
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OCCUPIED (1ULL << 56)
+
+// Zobrist key of a tile of value `2^exponent` at the given index. Keys are
+// derived with the SplitMix64 finalizer rather than drawn from a random
+// table, so grids of any size share the same keys without initialization.
+// Written as a constant expression to also fill the bitboard key table.
+#define MIX0(z) ((z) + 0x9E3779B97F4A7C15ULL)
+#define MIX1(z) (((z) ^ ((z) >> 30)) * 0xBF58476D1CE4E5B9ULL)
+#define MIX2(z) (((z) ^ ((z) >> 27)) * 0x94D049BB133111EBULL)
+#define MIX3(z) ((z) ^ ((z) >> 31))
+#define ZOBRIST_KEY(index, exponent)                                          \
+  MIX3(MIX2(MIX1(MIX0(((uint64_t)(index) << 8) | (uint64_t)(exponent)))))
+
+#define BITBOARD_KEYS(i)                                                      \
+  {                                                                           \
+    0, ZOBRIST_KEY(i, 1), ZOBRIST_KEY(i, 2), ZOBRIST_KEY(i, 3),               \
+        ZOBRIST_KEY(i, 4), ZOBRIST_KEY(i, 5), ZOBRIST_KEY(i, 6),              \
+        ZOBRIST_KEY(i, 7), ZOBRIST_KEY(i, 8), ZOBRIST_KEY(i, 9),              \
+        ZOBRIST_KEY(i, 10), ZOBRIST_KEY(i, 11), ZOBRIST_KEY(i, 12),           \
+        ZOBRIST_KEY(i, 13), ZOBRIST_KEY(i, 14), ZOBRIST_KEY(i, 15),           \
+  }
+
+// Keys of every (cell, exponent) pair of a bitboard, 0 for empty cells
+static const uint64_t BITBOARD_KEYS[16][16] = {
+    BITBOARD_KEYS(0),  BITBOARD_KEYS(1),  BITBOARD_KEYS(2),  BITBOARD_KEYS(3),
+    BITBOARD_KEYS(4),  BITBOARD_KEYS(5),  BITBOARD_KEYS(6),  BITBOARD_KEYS(7),
+    BITBOARD_KEYS(8),  BITBOARD_KEYS(9),  BITBOARD_KEYS(10), BITBOARD_KEYS(11),
+    BITBOARD_KEYS(12), BITBOARD_KEYS(13), BITBOARD_KEYS(14), BITBOARD_KEYS(15),
+};
+
+static inline uint64_t Pack(const TranspositionEntry *entry, uint8_t age) {
+  uint32_t value;
+  memcpy(&value, &entry->value, sizeof(value));
+  return (uint64_t)value | (uint64_t)entry->depth << 32 |
+         (uint64_t)entry->move << 40 | (uint64_t)age << 48 | OCCUPIED;
+}
+
+static inline void Unpack(uint64_t data, TranspositionEntry *entry) {
+  uint32_t value = (uint32_t)data;
+  memcpy(&entry->value, &value, sizeof(value));
+  entry->depth = (data >> 32) & 0xFF;
+  entry->move = (data >> 40) & 0xFF;
+}
+
+static inline uint8_t DataAge(uint64_t data) { return (data >> 48) & 0xFF; }
+
+static inline uint8_t DataDepth(uint64_t data) { return (data >> 32) & 0xFF; }
+
+void TranspositionInit(TranspositionTable *table, uint8_t bits) {
+  if (bits < 2) {
+    bits = 2;
+  }
+  *table = (TranspositionTable)malloc(sizeof(struct TranspositionTable));
+  (*table)->mask = ((uint64_t)1 << bits) - 1;
+  (*table)->slots = (TranspositionSlot *)malloc(
+      ((*table)->mask + 1) * sizeof(TranspositionSlot));
+  TranspositionClear(*table);
+}
+
+uint64_t TranspositionHashGrid(Grid grid) {
+  uint64_t hash = 0;
+  for (uint16_t i = 0; i < grid->length; ++i) {
+    if (grid->cells[i]) {
+      hash ^= ZOBRIST_KEY(i, __builtin_ctzll(grid->cells[i]));
+    }
+  }
+  return hash;
+}
+
+uint64_t TranspositionHashBitboard(Bitboard board) {
+  uint64_t hash = 0;
+  for (uint8_t i = 0; i < 16; ++i) {
+    hash ^= BITBOARD_KEYS[i][(board >> (4 * i)) & 0xF];
+  }
+  return hash;
+}
+
+static inline TranspositionSlot *Bucket(TranspositionTable table,
+                                        uint64_t hash) {
+  // Buckets start on a multiple of their size and never wrap around
+  return &table->slots[hash & table->mask &
+                       ~(uint64_t)(TRANSPOSITION_BUCKET_SIZE - 1)];
+}
+
+bool TranspositionProbe(TranspositionTable table, uint64_t hash, uint8_t depth,
+                        TranspositionEntry *entry) {
+  TranspositionSlot *bucket = Bucket(table, hash);
+  atomic_fetch_add_explicit(&table->probes, 1, memory_order_relaxed);
+  for (uint8_t i = 0; i < TRANSPOSITION_BUCKET_SIZE; ++i) {
+    uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+    uint64_t check =
+        atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+    if ((data & OCCUPIED) && (check ^ data) == hash) {
+      if (DataDepth(data) < depth) {
+        return false;
+      }
+      Unpack(data, entry);
+      atomic_fetch_add_explicit(&table->hits, 1, memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TranspositionStore(TranspositionTable table, uint64_t hash,
+                        const TranspositionEntry *entry) {
+  TranspositionSlot *bucket = Bucket(table, hash);
+  uint8_t age = atomic_load_explicit(&table->age, memory_order_relaxed);
+  TranspositionSlot *victim = NULL;
+  int victimRank = 0;
+  for (uint8_t i = 0; i < TRANSPOSITION_BUCKET_SIZE; ++i) {
+    uint64_t data = atomic_load_explicit(&bucket[i].data, memory_order_relaxed);
+    uint64_t check =
+        atomic_load_explicit(&bucket[i].check, memory_order_relaxed);
+    if (!(data & OCCUPIED)) {
+      victim = &bucket[i];
+      victimRank = -1;
+      break;
+    }
+    if ((check ^ data) == hash) {
+      victim = &bucket[i];
+      victimRank = -1;
+      break;
+    }
+    // Entries of the current search outrank older ones, then deeper ones win
+    int rank = (DataAge(data) == age) * 256 + DataDepth(data);
+    if (victim == NULL || rank < victimRank) {
+      victim = &bucket[i];
+      victimRank = rank;
+    }
+  }
+  if (victimRank >= 0) {
+    atomic_fetch_add_explicit(&table->overwrites, 1, memory_order_relaxed);
+  }
+  uint64_t data = Pack(entry, age);
+  atomic_store_explicit(&victim->check, hash ^ data, memory_order_relaxed);
+  atomic_store_explicit(&victim->data, data, memory_order_relaxed);
+  atomic_fetch_add_explicit(&table->stores, 1, memory_order_relaxed);
+}
+
+void TranspositionNewSearch(TranspositionTable table) {
+  atomic_fetch_add_explicit(&table->age, 1, memory_order_relaxed);
+}
+
+TranspositionStats TranspositionGetStats(TranspositionTable table) {
+  TranspositionStats stats = {
+      .probes = atomic_load_explicit(&table->probes, memory_order_relaxed),
+      .hits = atomic_load_explicit(&table->hits, memory_order_relaxed),
+      .stores = atomic_load_explicit(&table->stores, memory_order_relaxed),
+      .overwrites =
+          atomic_load_explicit(&table->overwrites, memory_order_relaxed),
+  };
+  return stats;
+}
+
+void TranspositionClear(TranspositionTable table) {
+  for (uint64_t i = 0; i <= table->mask; ++i) {
+    atomic_init(&table->slots[i].check, 0);
+    atomic_init(&table->slots[i].data, 0);
+  }
+  atomic_init(&table->age, 0);
+  atomic_init(&table->probes, 0);
+  atomic_init(&table->hits, 0);
+  atomic_init(&table->stores, 0);
+  atomic_init(&table->overwrites, 0);
+}
+
+void TranspositionFree(TranspositionTable *table) {
+  free((*table)->slots);
+  free(*table);
+  *table = NULL;
+}
@@ -7,10 +7,6 @@
 #include "xoshiro256ss.h"
 
 
-typedef struct Xoshiro256ss {
-  uint64_t state[4];
-} xoshiro256ss_t;
-
 random_engine_t *xoshiro256ss_ctor_full(const uint64_t seed[4]) {
 
   xoshiro256ss_t *data = malloc(sizeof(xoshiro256ss_t));
@@ -27,15 +23,24 @@ random_engine_t *xoshiro256ss_ctor_full(const uint64_t seed[4]) {
 }
 
 random_engine_t *xoshiro256ss_ctor_seed(uint64_t seed) {
-  return xoshiro256ss_ctor_full((uint64_t[]) {seed, seed, seed, seed});
+  xoshiro256ss_t rng;
+  xoshiro256ss_seed(&rng, seed);
+  return xoshiro256ss_ctor_full(rng.state);
 }
 
-random_engine_t *xoshiro256ss_ctor_rd(random_device_t *rd) {
+bool xoshiro256ss_seed_rd(xoshiro256ss_t *rng, random_device_t *rd) {
   uint64_t seed[4];
-  int result = random_device_read(rd, seed, sizeof(seed));
-  if (result == -1)
+  if (random_device_read(rd, seed, sizeof(seed)) != sizeof(seed))
+    return false;
+  memcpy(rng->state, seed, sizeof(rng->state));
+  return true;
+}
+
+random_engine_t *xoshiro256ss_ctor_rd(random_device_t *rd) {
+  xoshiro256ss_t rng;
+  if (!xoshiro256ss_seed_rd(&rng, rd))
     return NULL;
-  return xoshiro256ss_ctor_full(seed);
+  return xoshiro256ss_ctor_full(rng.state);
 }
 
 random_engine_t *xoshiro256ss_ctor(void) {
@@ -54,16 +59,79 @@ static uint64_t rotl(uint64_t x, uint64_t k) {
 }
 
 uint64_t xoshiro256ss_next(random_engine_t *engine) {
+  return xoshiro256ss_step(random_engine_data(engine));
+}
+
+void xoshiro256ss_fill(random_engine_t *engine, uint64_t *out, size_t n) {
+  // Keep the state in registers for the whole batch
   xoshiro256ss_t * data = random_engine_data(engine);
-  uint64_t result = rotl(data->state[1] * 5, 7) * 9;
-  uint64_t t = data->state[1] << 17;
-  data->state[2] ^= data->state[0];
-  data->state[3] ^= data->state[1];
-  data->state[1] ^= data->state[2];
-  data->state[0] ^= data->state[3];
-  data->state[2] ^= t;
-  data->state[3] = rotl(data->state[3], 45);
-  return result;
+  uint64_t s0 = data->state[0], s1 = data->state[1];
+  uint64_t s2 = data->state[2], s3 = data->state[3];
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = rotl(s1 * 5, 7) * 9;
+    uint64_t t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = rotl(s3, 45);
+  }
+  data->state[0] = s0;
+  data->state[1] = s1;
+  data->state[2] = s2;
+  data->state[3] = s3;
+}
+
+// Advance the state as many times as there are bits set in `polynomial`
+static void xoshiro256ss_jump_with(xoshiro256ss_t *rng,
+                                   const uint64_t polynomial[4]) {
+  uint64_t jumped[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    for (int b = 0; b < 64; ++b) {
+      if (polynomial[i] & (uint64_t)1 << b) {
+        for (int j = 0; j < 4; ++j) {
+          jumped[j] ^= rng->state[j];
+        }
+      }
+      xoshiro256ss_step(rng);
+    }
+  }
+  memcpy(rng->state, jumped, sizeof(rng->state));
+}
+
+void xoshiro256ss_jump_state(xoshiro256ss_t *rng) {
+  static const uint64_t JUMP[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                   0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  xoshiro256ss_jump_with(rng, JUMP);
+}
+
+void xoshiro256ss_jump(random_engine_t *engine) {
+  xoshiro256ss_jump_state(random_engine_data(engine));
+}
+
+void xoshiro256ss_long_jump(random_engine_t *engine) {
+  static const uint64_t LONG_JUMP[4] = {
+      0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL,
+      0x39109bb02acbe635ULL};
+  xoshiro256ss_jump_with(random_engine_data(engine), LONG_JUMP);
+}
+
+bool xoshiro256ss_fork(random_engine_t *engine, random_engine_t **children,
+                       size_t n) {
+  xoshiro256ss_t * data = random_engine_data(engine);
+  for (size_t i = 0; i < n; ++i) {
+    children[i] = xoshiro256ss_ctor_full(data->state);
+    if (!children[i]) {
+      while (i--) {
+        random_engine_dtor(children[i]);
+        children[i] = NULL;
+      }
+      return false;
+    }
+    xoshiro256ss_jump(engine);
+  }
+  return true;
 }
 
 const struct Xoshiro256ssSpec Xoshiro256ssEngine = {
@@ -72,6 +140,10 @@ const struct Xoshiro256ssSpec Xoshiro256ssEngine = {
     .ctor_full = xoshiro256ss_ctor_full,
     .ctor_seed = xoshiro256ss_ctor_seed,
     .ctor_rd = xoshiro256ss_ctor_rd,
+    .jump = xoshiro256ss_jump,
+    .long_jump = xoshiro256ss_long_jump,
+    .fork = xoshiro256ss_fork,
     .next = xoshiro256ss_next,
     .dtor = xoshiro256ss_dtor,
+    .fill = xoshiro256ss_fill,
 };
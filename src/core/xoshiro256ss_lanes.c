@@ -0,0 +1,264 @@
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "random.h"
+#include "xoshiro256ss.h"
+#include "xoshiro256ss_lanes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XOSHIRO256SS_LANES_X86 1
+#include <immintrin.h>
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#define LANES XOSHIRO256SS_LANES
+
+static void xoshiro256ss_lanes_fill_scalar(xoshiro256ss_lanes_t *lanes,
+                                           uint64_t *out, size_t n_steps) {
+  for (size_t l = 0; l < LANES; ++l) {
+    xoshiro256ss_t rng;
+    xoshiro256ss_lanes_get(lanes, l, &rng);
+    for (size_t s = 0; s < n_steps; ++s) {
+      out[s * LANES + l] = xoshiro256ss_step(&rng);
+    }
+    xoshiro256ss_lanes_set(lanes, l, &rng);
+  }
+}
+
+#ifdef XOSHIRO256SS_LANES_X86
+
+/* The multiplications by 5 and 9 are shifts and adds: AVX2 has no 64-bit
+ * multiplication and the AVX-512 one needs AVX512DQ. */
+
+TARGET_AVX2 static inline __m256i rotl_avx2(__m256i x, int k) {
+  return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+#define STEP_AVX2(s0, s1, s2, s3, result)                                     \
+  do {                                                                        \
+    __m256i times5 = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));          \
+    __m256i rotated = rotl_avx2(times5, 7);                                   \
+    result = _mm256_add_epi64(rotated, _mm256_slli_epi64(rotated, 3));        \
+    __m256i t = _mm256_slli_epi64(s1, 17);                                    \
+    s2 = _mm256_xor_si256(s2, s0);                                            \
+    s3 = _mm256_xor_si256(s3, s1);                                            \
+    s1 = _mm256_xor_si256(s1, s2);                                            \
+    s0 = _mm256_xor_si256(s0, s3);                                            \
+    s2 = _mm256_xor_si256(s2, t);                                             \
+    s3 = rotl_avx2(s3, 45);                                                   \
+  } while (0)
+
+// Lanes 0-3 and 4-7 in two sets of registers, interleaved to hide latencies
+TARGET_AVX2 static void xoshiro256ss_lanes_fill_avx2(
+    xoshiro256ss_lanes_t *lanes, uint64_t *out, size_t n_steps) {
+  __m256i a[4], b[4];
+  for (int w = 0; w < 4; ++w) {
+    a[w] = _mm256_loadu_si256((const __m256i *)&lanes->state[w][0]);
+    b[w] = _mm256_loadu_si256((const __m256i *)&lanes->state[w][4]);
+  }
+  for (size_t s = 0; s < n_steps; ++s) {
+    __m256i ra, rb;
+    STEP_AVX2(a[0], a[1], a[2], a[3], ra);
+    STEP_AVX2(b[0], b[1], b[2], b[3], rb);
+    _mm256_storeu_si256((__m256i *)&out[s * LANES], ra);
+    _mm256_storeu_si256((__m256i *)&out[s * LANES + 4], rb);
+  }
+  for (int w = 0; w < 4; ++w) {
+    _mm256_storeu_si256((__m256i *)&lanes->state[w][0], a[w]);
+    _mm256_storeu_si256((__m256i *)&lanes->state[w][4], b[w]);
+  }
+}
+
+TARGET_AVX512 static void xoshiro256ss_lanes_fill_avx512(
+    xoshiro256ss_lanes_t *lanes, uint64_t *out, size_t n_steps) {
+  __m512i s0 = _mm512_loadu_si512(lanes->state[0]);
+  __m512i s1 = _mm512_loadu_si512(lanes->state[1]);
+  __m512i s2 = _mm512_loadu_si512(lanes->state[2]);
+  __m512i s3 = _mm512_loadu_si512(lanes->state[3]);
+  for (size_t s = 0; s < n_steps; ++s) {
+    __m512i times5 = _mm512_add_epi64(s1, _mm512_slli_epi64(s1, 2));
+    __m512i rotated = _mm512_rol_epi64(times5, 7);
+    __m512i result = _mm512_add_epi64(rotated, _mm512_slli_epi64(rotated, 3));
+    __m512i t = _mm512_slli_epi64(s1, 17);
+    s2 = _mm512_xor_si512(s2, s0);
+    s3 = _mm512_xor_si512(s3, s1);
+    s1 = _mm512_xor_si512(s1, s2);
+    s0 = _mm512_xor_si512(s0, s3);
+    s2 = _mm512_xor_si512(s2, t);
+    s3 = _mm512_rol_epi64(s3, 45);
+    _mm512_storeu_si512(&out[s * LANES], result);
+  }
+  _mm512_storeu_si512(lanes->state[0], s0);
+  _mm512_storeu_si512(lanes->state[1], s1);
+  _mm512_storeu_si512(lanes->state[2], s2);
+  _mm512_storeu_si512(lanes->state[3], s3);
+}
+
+static bool supports_avx2(void) { return __builtin_cpu_supports("avx2"); }
+
+static bool supports_avx512(void) {
+  return __builtin_cpu_supports("avx512f");
+}
+
+#endif
+
+static bool always(void) { return true; }
+
+static bool __attribute__((unused)) never(void) { return false; }
+
+const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesScalar = {
+    "scalar", always, xoshiro256ss_lanes_fill_scalar};
+
+#ifdef XOSHIRO256SS_LANES_X86
+const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx2 = {
+    "avx2", supports_avx2, xoshiro256ss_lanes_fill_avx2};
+const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx512 = {
+    "avx512f", supports_avx512, xoshiro256ss_lanes_fill_avx512};
+#else
+const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx2 = {
+    "avx2", never, xoshiro256ss_lanes_fill_scalar};
+const xoshiro256ss_lanes_kernel_t Xoshiro256ssLanesAvx512 = {
+    "avx512f", never, xoshiro256ss_lanes_fill_scalar};
+#endif
+
+const xoshiro256ss_lanes_kernel_t *xoshiro256ss_lanes_kernel(void) {
+  static const xoshiro256ss_lanes_kernel_t *const CANDIDATES[] = {
+      &Xoshiro256ssLanesAvx512, &Xoshiro256ssLanesAvx2,
+      &Xoshiro256ssLanesScalar};
+  static _Atomic(const xoshiro256ss_lanes_kernel_t *) selected = NULL;
+  const xoshiro256ss_lanes_kernel_t *kernel =
+      atomic_load_explicit(&selected, memory_order_relaxed);
+  if (kernel == NULL) {
+    for (size_t i = 0; kernel == NULL; ++i) {
+      if (CANDIDATES[i]->supported()) {
+        kernel = CANDIDATES[i];
+      }
+    }
+    atomic_store_explicit(&selected, kernel, memory_order_relaxed);
+  }
+  return kernel;
+}
+
+void xoshiro256ss_lanes_seed(xoshiro256ss_lanes_t *lanes, uint64_t seed) {
+  xoshiro256ss_t rng;
+  xoshiro256ss_seed(&rng, seed);
+  for (size_t l = 0; l < LANES; ++l) {
+    xoshiro256ss_lanes_set(lanes, l, &rng);
+    xoshiro256ss_jump_state(&rng);
+  }
+}
+
+void xoshiro256ss_lanes_set(xoshiro256ss_lanes_t *lanes, size_t lane,
+                            const xoshiro256ss_t *rng) {
+  for (int w = 0; w < 4; ++w) {
+    lanes->state[w][lane] = rng->state[w];
+  }
+}
+
+void xoshiro256ss_lanes_get(const xoshiro256ss_lanes_t *lanes, size_t lane,
+                            xoshiro256ss_t *rng) {
+  for (int w = 0; w < 4; ++w) {
+    rng->state[w] = lanes->state[w][lane];
+  }
+}
+
+void xoshiro256ss_lanes_fill(xoshiro256ss_lanes_t *lanes, uint64_t *out,
+                             size_t n_steps) {
+  xoshiro256ss_lanes_kernel()->fill(lanes, out, n_steps);
+}
+
+/* Multi-stream engine */
+
+typedef struct Xoshiro256ssLanesEngineData {
+  xoshiro256ss_lanes_t lanes;
+  xoshiro256ss_lanes_fill_fn fill; ///< Kernel selected at construction
+  size_t position;                 ///< First number of `step` not served yet
+  uint64_t step[LANES];            ///< Numbers of the last step
+} xoshiro256ss_lanes_engine_data_t;
+
+static random_engine_t *
+xoshiro256ss_lanes_engine_ctor_lanes(const xoshiro256ss_lanes_t *lanes) {
+  xoshiro256ss_lanes_engine_data_t *data = malloc(sizeof(*data));
+  if (!data) {
+    return NULL;
+  }
+  random_engine_t *engine = random_engine_ctor(
+      (random_engine_spec_t)&Xoshiro256ssLanesEngine, data);
+  if (!engine) {
+    free(data);
+    return NULL;
+  }
+  data->lanes = *lanes;
+  data->fill = xoshiro256ss_lanes_kernel()->fill;
+  data->position = LANES; // stepped on first use
+  return engine;
+}
+
+random_engine_t *xoshiro256ss_lanes_engine_ctor_seed(uint64_t seed) {
+  xoshiro256ss_lanes_t lanes;
+  xoshiro256ss_lanes_seed(&lanes, seed);
+  return xoshiro256ss_lanes_engine_ctor_lanes(&lanes);
+}
+
+random_engine_t *xoshiro256ss_lanes_engine_ctor(void) {
+  xoshiro256ss_lanes_t lanes;
+  random_device_t *rd = random_device_ctor();
+  if (!rd) {
+    return NULL;
+  }
+  bool seeded = true;
+  for (size_t l = 0; l < LANES && seeded; ++l) {
+    xoshiro256ss_t rng;
+    seeded = xoshiro256ss_seed_rd(&rng, rd);
+    xoshiro256ss_lanes_set(&lanes, l, &rng);
+  }
+  random_device_dtor(rd);
+  return seeded ? xoshiro256ss_lanes_engine_ctor_lanes(&lanes) : NULL;
+}
+
+uint64_t xoshiro256ss_lanes_engine_next(random_engine_t *engine) {
+  xoshiro256ss_lanes_engine_data_t *data = random_engine_data(engine);
+  if (data->position == LANES) {
+    data->fill(&data->lanes, data->step, 1);
+    data->position = 0;
+  }
+  return data->step[data->position++];
+}
+
+void xoshiro256ss_lanes_engine_fill(random_engine_t *engine, uint64_t *out,
+                                    size_t n) {
+  xoshiro256ss_lanes_engine_data_t *data = random_engine_data(engine);
+  // Numbers left from the last step, then whole steps, then a partial step
+  size_t left = LANES - data->position;
+  if (left > n) {
+    left = n;
+  }
+  memcpy(out, data->step + data->position, left * sizeof(uint64_t));
+  data->position += left;
+  out += left;
+  n -= left;
+  data->fill(&data->lanes, out, n / LANES);
+  out += n / LANES * LANES;
+  n %= LANES;
+  if (n > 0) {
+    data->fill(&data->lanes, data->step, 1);
+    memcpy(out, data->step, n * sizeof(uint64_t));
+    data->position = n;
+  }
+}
+
+void xoshiro256ss_lanes_engine_dtor(random_engine_t *engine) {
+  free(random_engine_data(engine));
+}
+
+const struct RandomEngineSpec Xoshiro256ssLanesEngine = {
+    .name = "Xoshiro256**x8",
+    .ctor = xoshiro256ss_lanes_engine_ctor,
+    .next = xoshiro256ss_lanes_engine_next,
+    .dtor = xoshiro256ss_lanes_engine_dtor,
+    .fill = xoshiro256ss_lanes_engine_fill,
+};
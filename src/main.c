@@ -2,6 +2,7 @@
 #include "core/grid.h"
 #include "reasing.h"
 #include <raylib.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,11 +17,8 @@ Color GetTileColor(uint64_t number) {
   if (number == 0) {
     return BLANK;
   }
-  int i = -1;
-  while (number >>= 1) {
-    ++i;
-  }
-  return COLORS[i % MAX_COLORS_COUNT];
+  // Tiles are powers of two, 2 gets the first color
+  return COLORS[(__builtin_ctzll(number) - 1) % MAX_COLORS_COUNT];
 }
 
 const float gap = 10.0f;
@@ -35,11 +33,131 @@ static inline Vector2 GetTilePosition(float tileSize, int index,
   return pos;
 }
 
+// Used when the refresh rate of the monitor cannot be queried
+#define DEFAULT_REFRESH_RATE 60
+
 static inline int GetCurrentRefreshRate(void) {
-  return GetMonitorRefreshRate(GetCurrentMonitor());
+  int rate = GetMonitorRefreshRate(GetCurrentMonitor());
+  return rate > 0 ? rate : DEFAULT_REFRESH_RATE;
+}
+
+// Rate input is polled at while a game is in progress and nothing moves,
+// the clock only changes once a second
+#define IDLE_POLL_RATE 30
+
+// Duration of the slide of the tiles after a move, in seconds
+#define MOVE_DURATION 0.12f
+
+/**
+ * Slide of a tile during the animation of a move, built once per move
+ */
+typedef struct Tween {
+  Rectangle from; ///< Tile the tile leaves
+  Rectangle to;   ///< Tile the tile slides to
+  uint64_t value; ///< Value of the tile before the move
+} Tween;
+
+// Moves played but not animated yet that are kept, the oldest animation is
+// skipped when another move comes
+#define MOVE_QUEUE_SIZE 4
+
+/**
+ * Animation of a move, the tiles of the grid before it sliding to their cells
+ */
+typedef struct MoveAnimation {
+  Tween *tweens;
+  uint16_t count;
+} MoveAnimation;
+
+// Build a tween for every tile of the old cells, sliding to the cell the
+// diff of the move sends it to
+static uint16_t BuildTweens(Tween *tweens, const uint64_t *oldCells,
+                            const uint16_t *diff, const Rectangle *tiles,
+                            uint16_t gridLength) {
+  uint16_t count = 0;
+  for (uint16_t i = 0; i < gridLength; ++i) {
+    if (oldCells[i] != 0) {
+      tweens[count++] = (Tween){tiles[i], tiles[diff[i]], oldCells[i]};
+    }
+  }
+  return count;
+}
+
+// Position of a tween `time` seconds into the animation
+static Rectangle TweenAt(const Tween *tween, float time) {
+  Rectangle rect = tween->from;
+  rect.x = EaseSineInOut(time, tween->from.x, tween->to.x - tween->from.x,
+                         MOVE_DURATION);
+  rect.y = EaseSineInOut(time, tween->from.y, tween->to.y - tween->from.y,
+                         MOVE_DURATION);
+  return rect;
+}
+
+// Largest font size of the value of a tile
+#define LABEL_MAX_SIZE 24
+// Tiles hold 2^1 to 2^63
+#define LABEL_COUNT 64
+
+/**
+ * Values of the tiles, rendered once into a texture with one row per exponent
+ */
+typedef struct LabelAtlas {
+  Texture2D texture;
+  float tileSize;                ///< Size of the tiles the labels fit in
+  Rectangle labels[LABEL_COUNT]; ///< Label of 2^i in the texture
+} LabelAtlas;
+
+// Render the value of every tile into the atlas, each with the largest font
+// size that fits a tile of the given size
+static void LabelAtlasLoad(LabelAtlas *atlas, float tileSize) {
+  int width = (int)tileSize;
+  Image image = GenImageColor(width, LABEL_MAX_SIZE * LABEL_COUNT, BLANK);
+  atlas->labels[0] = (Rectangle){0};
+  for (int i = 1; i < LABEL_COUNT; ++i) {
+    const char *text = TextFormat("%lu", (uint64_t)1 << i);
+    int size = LABEL_MAX_SIZE;
+    while (size > 1 && MeasureText(text, size) > width - 4) {
+      --size;
+    }
+    int y = i * LABEL_MAX_SIZE;
+    ImageDrawText(&image, text, 0, y, size, RAYWHITE);
+    atlas->labels[i] =
+        (Rectangle){0, (float)y, (float)MeasureText(text, size), (float)size};
+  }
+  atlas->texture = LoadTextureFromImage(image);
+  atlas->tileSize = tileSize;
+  UnloadImage(image);
+}
+
+static void LabelAtlasUnload(LabelAtlas *atlas) {
+  UnloadTexture(atlas->texture);
+}
+
+// Draw the label of a tile centered on it, every label comes from the same
+// texture so raylib batches them into a single draw call
+static void DrawTileLabel(const LabelAtlas *atlas, Rectangle rect,
+                          uint64_t value) {
+  Rectangle label = atlas->labels[__builtin_ctzll(value) % LABEL_COUNT];
+  Vector2 pos = {
+      (float)(int)(rect.x + (rect.width - label.width) / 2),
+      (float)(int)(rect.y + (rect.height - label.height) / 2),
+  };
+  DrawTextureRec(atlas->texture, label, pos, WHITE);
 }
-static inline int TimeMsToFrames(int ms) {
-  return (float)ms / 1000.0f * (float) GetCurrentRefreshRate();
+
+// Cover a region of the texture being drawn to with the same region of the
+// static layer
+static void DrawBackgroundRegion(const RenderTexture2D *background,
+                                 Rectangle region) {
+  // Render textures are stored upside down
+  Rectangle source = {
+      region.x,
+      (float)background->texture.height - region.y - region.height,
+      region.width,
+      -region.height,
+  };
+  DrawTextureRec(background->texture, source, (Vector2){region.x, region.y},
+                 WHITE);
 }
 
 int main(void) {
@@ -47,13 +165,14 @@ int main(void) {
   //--------------------------------------------------------------------------------------
   const int screenWidth = 640;
   const int screenHeight = 960;
-  int framesCounter = 0;
 
   InitWindow(screenWidth, screenHeight, "r2048");
-  SetTargetFPS(
-      GetCurrentRefreshRate()); // Set our game to run at monitor refresh rate
+  const int refreshRate = GetCurrentRefreshRate();
+  SetTargetFPS(refreshRate); // Set our game to run at monitor refresh rate
   //--------------------------------------------------------------------------------------
   double startTime = GetTime();
+  // Whether raylib blocks on input at the end of a frame
+  bool waiting = false;
 
   const char txtMoves[] = "Moves";
   const int txtMovesSize = 16;
@@ -65,19 +184,35 @@ int main(void) {
   const char txtScoreFormat[] = "%u";
   const int txtScoreSize = 40;
   int txtScoreWidth = 0;
-  const char txtTileFormat[] = "%lu";
-  int txtTileSize = 24;
-  int txtTileWidth = 0;
+
+  // Moves that can be undone
+  const uint32_t historyMoves = 4096;
 
   Game game;
   GameInit(&game, 4);
+  GameRecordHistory(game, historyMoves);
+  // The session is kept as a replay, for `r2048-sim -r`
+  FILE *replay = fopen("r2048.replay", "wb");
+  if (replay && !GameRecordReplay(game, replay)) {
+    fclose(replay);
+    replay = NULL;
+  }
   uint16_t *diff = (uint16_t *)calloc(game->grid->length, sizeof(uint16_t));
   bool gameOver = false;
   uint8_t gridSize = game->grid->size;
   uint16_t gridLength = game->grid->length;
   uint64_t *oldCells = (uint64_t *)calloc(gridLength, sizeof(uint64_t));
   Rectangle *tiles = (Rectangle *)calloc(gridLength, sizeof(Rectangle));
-  Rectangle *movingTiles = (Rectangle *)calloc(gridLength, sizeof(Rectangle));
+  // Animations of the moves the game is ahead of the screen by, as a ring
+  Tween *tweens =
+      (Tween *)calloc((size_t)MOVE_QUEUE_SIZE * gridLength, sizeof(Tween));
+  MoveAnimation queue[MOVE_QUEUE_SIZE];
+  for (int i = 0; i < MOVE_QUEUE_SIZE; ++i) {
+    queue[i].tweens = tweens + (size_t)i * gridLength;
+    queue[i].count = 0;
+  }
+  uint8_t queueHead = 0;
+  uint8_t queued = 0;
 
   const float tileSize =
       (((float)GetScreenWidth() - (margin * 2) - (gap * (gridSize - 1))) /
@@ -89,39 +224,105 @@ int main(void) {
     tiles[i].width = tileSize;
     tiles[i].height = tileSize;
   }
-  bool moving = false;
+  LabelAtlas labels;
+  LabelAtlasLoad(&labels, tileSize);
+  // Time into the animation at the head of the queue, in seconds, and when
+  // it was last advanced
+  float moveTime = 0.0f;
+  double animationClock = 0.0;
+  // Whether a move is left, only looked for again when the grid changes
+  bool canMove = GameCanMove(game);
+  // The clock stops when the game is over
+  double endTime = 0.0;
+  int elapsedSeconds = 0;
+
+  // What never changes, drawn once: the window background, the empty tiles
+  // and the moves label
+  RenderTexture2D background = LoadRenderTexture(screenWidth, screenHeight);
+  BeginTextureMode(background);
+  ClearBackground(RAYWHITE);
+  for (int i = 0; i < gridLength; ++i) {
+    DrawRectangleRec(tiles[i], LIGHTGRAY); // Draw background tile
+  }
+  DrawText(txtMoves, 20, 20, txtMovesSize, GRAY);
+  EndTextureMode();
+  const Rectangle screenRegion = {0, 0, screenWidth, screenHeight};
+  const Rectangle scoreRegion = {120, 20, screenWidth - 240, txtScoreSize};
+  const Rectangle elapsedRegion = {120, 70, screenWidth - 240, 20};
+  const Rectangle movesRegion = {0, 20 + txtMovesSize, 120, txtMovesCountSize};
+  const Rectangle fpsRegion = {screenWidth - 120, 20, 120, 20};
+  const Rectangle lastTile = tiles[gridLength - 1];
+  const Rectangle boardRegion = {
+      tiles[0].x,
+      tiles[0].y,
+      lastTile.x + lastTile.width - tiles[0].x,
+      lastTile.y + lastTile.height - tiles[0].y,
+  };
+
+  // Last frame, shown again as is while nothing on it changes. Only the
+  // regions that differ from what it shows are drawn again
+  RenderTexture2D frame = LoadRenderTexture(screenWidth, screenHeight);
+  BeginTextureMode(frame);
+  DrawBackgroundRegion(&background, screenRegion);
+  EndTextureMode();
+  uint64_t *shownCells = (uint64_t *)calloc(gridLength, sizeof(uint64_t));
+  uint64_t shownScore = UINT64_MAX;
+  uint32_t shownMoves = UINT32_MAX;
+  int shownSeconds = -1;
+  bool shownGameOver = false;
+  // Whether the board shows the cells at rest, and whether they may have
+  // changed since
+  bool boardShown = false;
+  bool cellsChanged = false;
   // Main game loop
   while (!WindowShouldClose()) // Detect window close button or ESC key
   {
     // Update
     //----------------------------------------------------------------------------------
-    ++framesCounter;
+    bool changed = false;
     if (gameOver) {
       if (IsKeyPressed(KEY_ENTER)) {
-        GameFree(&game);
-        free(diff);
-        free(oldCells);
-        GameInit(&game, 4);
-        gridSize = game->grid->size;
-        gridLength = game->grid->length;
-        diff = calloc(gridLength, sizeof(uint16_t));
-        oldCells = calloc(gridLength, sizeof(uint64_t));
+        // Same grid size, the game and its buffers are reused
+        GameReset(game);
         gameOver = false;
         startTime = GetTime();
+        changed = true;
+      } else if (IsKeyPressed(KEY_Z) && GameUndo(game)) {
+        gameOver = false;
+        changed = true;
       }
-    } else if (moving) {
-
+    } else if (!canMove && queued == 0) {
+      gameOver = true;
+      endTime = GetTime();
     } else {
-      if (GridAnyCellAvailable(game->grid) || GameTileMatchesAvailable(game)) {
+      if (queued > 0) {
+        // The screen runs behind the game, faster the more moves wait
+        double now = GetTime();
+        moveTime += (float)(now - animationClock) * queued;
+        animationClock = now;
+        if (moveTime >= MOVE_DURATION) {
+          queueHead = (queueHead + 1) % MOVE_QUEUE_SIZE;
+          --queued;
+          moveTime = 0.0f;
+        }
+      }
+      // Every key pressed since the last frame, in order. A move is played at
+      // once and only its animation is queued
+      for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
         int direction = -1;
-        if (IsKeyPressed(KEY_LEFT)) {
+        if (key == KEY_LEFT) {
           direction = LEFT;
-        } else if (IsKeyPressed(KEY_UP)) {
+        } else if (key == KEY_UP) {
           direction = UP;
-        } else if (IsKeyPressed(KEY_RIGHT)) {
+        } else if (key == KEY_RIGHT) {
           direction = RIGHT;
-        } else if (IsKeyPressed(KEY_DOWN)) {
+        } else if (key == KEY_DOWN) {
           direction = DOWN;
+        } else if ((key == KEY_Z && GameUndo(game)) ||
+                   (key == KEY_Y && GameRedo(game))) {
+          // The queued animations do not lead to this grid
+          queued = 0;
+          changed = true;
         }
         if (direction != -1) {
           memcpy(oldCells, game->grid->cells, gridLength * sizeof(uint64_t));
@@ -129,159 +330,216 @@ int main(void) {
           if (moved) {
             GameAddRandomTile(game);
             ++game->moves;
-            memcpy(movingTiles, tiles, gridLength * sizeof(Rectangle));
-            moving = true;
+            if (queued == MOVE_QUEUE_SIZE) {
+              queueHead = (queueHead + 1) % MOVE_QUEUE_SIZE;
+              --queued;
+              moveTime = 0.0f;
+            }
+            MoveAnimation *animation =
+                &queue[(queueHead + queued) % MOVE_QUEUE_SIZE];
+            animation->count = BuildTweens(animation->tweens, oldCells, diff,
+                                           tiles, gridLength);
+            if (queued++ == 0) {
+              moveTime = 0.0f;
+              animationClock = GetTime();
+            }
+            changed = true;
           }
         }
+      }
+    }
+    if (changed) {
+      canMove = GameCanMove(game);
+      cellsChanged = true;
+    }
+    elapsedSeconds = (int)((gameOver ? endTime : GetTime()) - startTime);
+    // Once the game is over and settled, the clock is stopped and only input
+    // changes the frame: the loop blocks until some comes
+    bool wait = queued == 0 && gameOver;
+    if (wait != waiting) {
+      if (wait) {
+        EnableEventWaiting();
       } else {
-        gameOver = true;
+        DisableEventWaiting();
       }
+      waiting = wait;
     }
     //----------------------------------------------------------------------------------
 
     // Draw
     //----------------------------------------------------------------------------------
-    BeginDrawing();
-    ClearBackground(RAYWHITE);
-    const char *txtScore = TextFormat(txtScoreFormat, game->score);
-    txtScoreWidth = MeasureText(txtScore, txtScoreSize);
-    DrawText(txtScore, (GetScreenWidth() - txtScoreWidth) / 2, 20, txtScoreSize,
-             GRAY);
-    double elapsedTime = GetTime() - startTime;
-    int hours = (int)elapsedTime / 3600;
-    int minutes = ((int)elapsedTime % 3600) / 60;
-    int seconds = (int)elapsedTime % 60;
-    const char *txtElapsedFormat = "%02u:%02u:%02u";
-    const char *txtElapsed = TextFormat(txtElapsedFormat, hours, minutes, seconds);
-    const int txtElapsedSize = 20;
-    const int txtElapsedWidth = MeasureText(txtElapsed, txtElapsedSize);
-    DrawText(txtElapsed, (GetScreenWidth() - txtElapsedWidth) / 2, 70,
-             txtElapsedSize, GRAY);
-    const char *txtMovesCount = TextFormat(txtMovesCountFormat, game->moves);
-    txtMovesCountWidth = MeasureText(txtMovesCount, txtMovesCountSize);
-    DrawText(txtMoves, 20, 20, txtMovesSize, GRAY);
-    DrawText(txtMovesCount, 20 + (txtMovesWidth - txtMovesCountWidth) / 2,
-             20 + txtMovesSize, txtMovesCountSize, GRAY);
+    bool animating = queued > 0;
+    bool drawBoard = animating || !boardShown || gameOver != shownGameOver;
+    bool drawCells = !drawBoard && cellsChanged;
+    bool drawScore = game->score != shownScore;
+    bool drawMoves = game->moves != shownMoves;
+    bool drawElapsed = elapsedSeconds != shownSeconds;
+    if (!drawBoard && !drawCells && !drawScore && !drawMoves && !drawElapsed &&
+        !IsWindowResized()) {
+      // The frame on screen is still up to date. While the clock runs, input
+      // and the clock are polled at a low rate, nothing is drawn
+      if (!waiting) {
+        WaitTime(1.0 / IDLE_POLL_RATE);
+      }
+      PollInputEvents();
+      continue;
+    }
+    BeginTextureMode(frame);
+    if (drawScore) {
+      DrawBackgroundRegion(&background, scoreRegion);
+      const char *txtScore = TextFormat(txtScoreFormat, game->score);
+      txtScoreWidth = MeasureText(txtScore, txtScoreSize);
+      DrawText(txtScore, (GetScreenWidth() - txtScoreWidth) / 2, 20,
+               txtScoreSize, GRAY);
+      shownScore = game->score;
+    }
+    if (drawElapsed) {
+      DrawBackgroundRegion(&background, elapsedRegion);
+      int hours = elapsedSeconds / 3600;
+      int minutes = (elapsedSeconds % 3600) / 60;
+      int seconds = elapsedSeconds % 60;
+      const char *txtElapsedFormat = "%02u:%02u:%02u";
+      const char *txtElapsed =
+          TextFormat(txtElapsedFormat, hours, minutes, seconds);
+      const int txtElapsedSize = 20;
+      const int txtElapsedWidth = MeasureText(txtElapsed, txtElapsedSize);
+      DrawText(txtElapsed, (GetScreenWidth() - txtElapsedWidth) / 2, 70,
+               txtElapsedSize, GRAY);
+      shownSeconds = elapsedSeconds;
+    }
+    if (drawMoves) {
+      DrawBackgroundRegion(&background, movesRegion);
+      const char *txtMovesCount = TextFormat(txtMovesCountFormat, game->moves);
+      txtMovesCountWidth = MeasureText(txtMovesCount, txtMovesCountSize);
+      DrawText(txtMovesCount, 20 + (txtMovesWidth - txtMovesCountWidth) / 2,
+               20 + txtMovesSize, txtMovesCountSize, GRAY);
+      shownMoves = game->moves;
+    }
+    // The FPS of the frames that were drawn, it changes with any of them
+    DrawBackgroundRegion(&background, fpsRegion);
     DrawFPS(GetScreenWidth() - 100, 20);
 
-    for (int i = 0; i < gridLength; ++i) // Draw all rectangles
-    {
-      Rectangle bgTile = tiles[i];
-      DrawRectangleRec(bgTile, LIGHTGRAY); // Draw background tile
-      if (moving) {
-        ++framesCounter;
-        const int totalFrames = TimeMsToFrames(2000); // 1 second
+    const uint64_t *cells = game->grid->cells;
+    // Every tile is drawn once, the labels after all the tiles so they are
+    // batched together
+    if (drawBoard) {
+      DrawBackgroundRegion(&background, boardRegion);
+      if (animating) {
+        const MoveAnimation *animation = &queue[queueHead];
+        const Tween *tween = animation->tweens;
+        for (uint16_t t = 0; t < animation->count; ++t) {
+          DrawRectangleRec(TweenAt(&tween[t], moveTime),
+                           GetTileColor(tween[t].value));
+        }
+        for (uint16_t t = 0; t < animation->count; ++t) {
+          DrawTileLabel(&labels, TweenAt(&tween[t], moveTime), tween[t].value);
+        }
+      } else {
         for (int i = 0; i < gridLength; ++i) {
-          uint16_t oldIndex = i;
-          uint16_t newIndex = diff[oldIndex];
-          Rectangle oldTile = movingTiles[oldIndex];
-          Rectangle actualTile = movingTiles[oldIndex];
-          Rectangle newTile = tiles[newIndex];
-          if (oldCells[oldIndex] == 0) {
-            continue;
-          }
-          if (oldTile.x != newTile.x) {
-            actualTile.x = EaseSineInOut((float)framesCounter, oldTile.x,
-                                         newTile.x - oldTile.x, totalFrames);
+          if (cells[i] != 0) {
+            DrawRectangleRec(tiles[i], GetTileColor(cells[i]));
           }
-          if (oldTile.y != newTile.y) {
-            actualTile.y = EaseSineInOut((float)framesCounter, oldTile.y,
-                                         newTile.y - oldTile.y, totalFrames);
-          }
-          DrawRectangleRec(actualTile, GetTileColor(oldCells[oldIndex]));
-
-          // if (CheckCollisionRecs(actualTile, newTile)) {
-          //     Rectangle collideTarget = GetCollisionRec(actualTile, newTile);
-          //     // DrawRectangleRec(collideTarget,
-          //     GetTileColor(game->grid->cells[newIndex])); if
-          //     (oldCells[newIndex] != 0 && oldIndex != newIndex)
-          //     DrawRectangleRec(collideTarget, RED);
-          // }
-
-          const char *txtTile = TextFormat(txtTileFormat, oldCells[oldIndex]);
-          while (MeasureText(txtTile, txtTileSize) >
-                 (int)actualTile.width - 4) {
-            --txtTileSize;
+        }
+        for (int i = 0; i < gridLength; ++i) {
+          if (cells[i] != 0) {
+            DrawTileLabel(&labels, tiles[i], cells[i]);
           }
-          txtTileWidth = MeasureText(txtTile, txtTileSize);
-          int txtTileX = (int)(actualTile.x +
-                               (actualTile.width - (float)txtTileWidth) / 2);
-          int txtTileY = (int)(actualTile.y +
-                               (actualTile.height - (float)txtTileSize) / 2);
-          DrawText(txtTile, txtTileX, txtTileY, txtTileSize, RAYWHITE);
         }
-        if (framesCounter >= totalFrames) {
-          moving = false;
-          framesCounter = 0;
+        memcpy(shownCells, cells, gridLength * sizeof(uint64_t));
+        if (gameOver) {
+          const char *txtGameOver = "Game Over!";
+          const int txtGameOverSize = 54;
+          const int txtGameOverWidth =
+              MeasureText(txtGameOver, txtGameOverSize);
+          const char *txtTryAgain = "Press [Enter] to try again";
+          const int txtTryAgainSize = 20;
+          const int txtTryAgainWidth =
+              MeasureText(txtTryAgain, txtTryAgainSize);
+
+          const Vector2 firstTilePos = GetTilePosition(tileSize, 0, gridSize);
+          Vector2 lastTilePos =
+              GetTilePosition(tileSize, gridLength - 1, gridSize);
+          lastTilePos.x += tileSize + gap;
+          lastTilePos.y += tileSize + gap;
+          const Vector2 txtGameOverPos = {
+              (GetScreenWidth() - txtGameOverWidth) / 2.0f,
+              firstTilePos.y + ((lastTilePos.y - firstTilePos.y) / 2.0f) -
+                  ((txtGameOverSize / 2.0f) + (txtTryAgainSize / 2.0f) + 5),
+          };
+          const Vector2 txtTryAgainPos = {
+              (GetScreenWidth() - txtTryAgainWidth) / 2.0f,
+              txtGameOverPos.y + txtGameOverSize + 10,
+          };
+
+          Rectangle bg = {txtGameOverPos.x - 20, txtGameOverPos.y - 20,
+                          txtGameOverWidth + 40,
+                          txtGameOverSize + 10 + txtTryAgainSize + 40};
+          DrawRectangleRec(
+              (Rectangle){
+                  bg.x + 6,
+                  bg.y + 6,
+                  bg.width,
+                  bg.height,
+              },
+              BLACK);
+          DrawRectangleRec(bg, RAYWHITE);
+          DrawRectangleRec(bg, Fade(RED, 0.3f));
+          DrawRectangleLinesEx(bg, 4, RED);
+          DrawText(txtGameOver, txtGameOverPos.x, txtGameOverPos.y,
+                   txtGameOverSize, RED);
+          DrawText(txtTryAgain, txtTryAgainPos.x, txtTryAgainPos.y,
+                   txtTryAgainSize, GRAY);
         }
-      } else {
-        DrawRectangleRec(tiles[i], GetTileColor(game->grid->cells[i]));
-        if (game->grid->cells[i] == 0) {
-          continue;
+      }
+      boardShown = !animating;
+      shownGameOver = gameOver;
+    } else if (drawCells) {
+      // Only the tiles whose value changed, the empty tile of the static
+      // layer first
+      for (int i = 0; i < gridLength; ++i) {
+        if (cells[i] != shownCells[i]) {
+          DrawBackgroundRegion(&background, tiles[i]);
         }
-        const char *txtTile = TextFormat(txtTileFormat, game->grid->cells[i]);
-        while (MeasureText(txtTile, txtTileSize) > (int)tiles[i].width - 4) {
-          --txtTileSize;
+      }
+      for (int i = 0; i < gridLength; ++i) {
+        if (cells[i] != shownCells[i] && cells[i] != 0) {
+          DrawRectangleRec(tiles[i], GetTileColor(cells[i]));
         }
-        txtTileWidth = MeasureText(txtTile, txtTileSize);
-        int txtTileX =
-            (int)(tiles[i].x + (tiles[i].width - (float)txtTileWidth) / 2);
-        int txtTileY =
-            (int)(tiles[i].y + (tiles[i].height - (float)txtTileSize) / 2);
-        DrawText(txtTile, txtTileX, txtTileY, txtTileSize, RAYWHITE);
       }
+      for (int i = 0; i < gridLength; ++i) {
+        if (cells[i] != shownCells[i] && cells[i] != 0) {
+          DrawTileLabel(&labels, tiles[i], cells[i]);
+        }
+      }
+      memcpy(shownCells, cells, gridLength * sizeof(uint64_t));
     }
-    if (gameOver) {
-      const char *txtGameOver = "Game Over!";
-      const int txtGameOverSize = 54;
-      const int txtGameOverWidth = MeasureText(txtGameOver, txtGameOverSize);
-      const char *txtTryAgain = "Press [Enter] to try again";
-      const int txtTryAgainSize = 20;
-      const int txtTryAgainWidth = MeasureText(txtTryAgain, txtTryAgainSize);
-
-      const Vector2 firstTilePos = GetTilePosition(tileSize, 0, gridSize);
-      Vector2 lastTilePos = GetTilePosition(tileSize, gridLength - 1, gridSize);
-      lastTilePos.x += tileSize + gap;
-      lastTilePos.y += tileSize + gap;
-      const Vector2 txtGameOverPos = {
-          (GetScreenWidth() - txtGameOverWidth) / 2.0f,
-          firstTilePos.y + ((lastTilePos.y - firstTilePos.y) / 2.0f) -
-              ((txtGameOverSize / 2.0f) + (txtTryAgainSize / 2.0f) + 5),
-      };
-      const Vector2 txtTryAgainPos = {
-          (GetScreenWidth() - txtTryAgainWidth) / 2.0f,
-          txtGameOverPos.y + txtGameOverSize + 10,
-      };
-
-      Rectangle bg = {txtGameOverPos.x - 20, txtGameOverPos.y - 20,
-                      txtGameOverWidth + 40,
-                      txtGameOverSize + 10 + txtTryAgainSize + 40};
-      DrawRectangleRec(
-          (Rectangle){
-              bg.x + 6,
-              bg.y + 6,
-              bg.width,
-              bg.height,
-          },
-          BLACK);
-      DrawRectangleRec(bg, RAYWHITE);
-      DrawRectangleRec(bg, Fade(RED, 0.3f));
-      DrawRectangleLinesEx(bg, 4, RED);
-      DrawText(txtGameOver, txtGameOverPos.x, txtGameOverPos.y, txtGameOverSize,
-               RED);
-      DrawText(txtTryAgain, txtTryAgainPos.x, txtTryAgainPos.y, txtTryAgainSize,
-               GRAY);
-    }
+    cellsChanged = false;
+    EndTextureMode();
+
+    BeginDrawing();
+    // Render textures are stored upside down
+    DrawTextureRec(frame.texture,
+                   (Rectangle){0, 0, (float)frame.texture.width,
+                               -(float)frame.texture.height},
+                   (Vector2){0, 0}, WHITE);
     EndDrawing();
     //----------------------------------------------------------------------------------
   }
 
   // De-Initialization
   //--------------------------------------------------------------------------------------
+  UnloadRenderTexture(frame);
+  UnloadRenderTexture(background);
+  LabelAtlasUnload(&labels);
+  free(shownCells);
+  free(tweens);
   free(tiles);
   free(diff);
   free(oldCells);
   GameFree(&game);
+  if (replay) {
+    fclose(replay);
+  }
   CloseWindow(); // Close window and OpenGL context
   //--------------------------------------------------------------------------------------
 
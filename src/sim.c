@@ -0,0 +1,430 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "core/ai.h"
+#include "core/game.h"
+#include "core/grid.h"
+#include "core/replay.h"
+#include "core/transposition.h"
+#include "random.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef enum {
+  POLICY_RANDOM,
+  POLICY_GREEDY,
+  POLICY_CORNER,
+  POLICY_EXPECTIMAX
+} Policy;
+
+static const char *POLICY_NAMES[] = {"random", "greedy", "corner",
+                                     "expectimax"};
+
+#define POLICY_COUNT (sizeof(POLICY_NAMES) / sizeof(POLICY_NAMES[0]))
+#define MAX_EXPONENT 64
+
+typedef struct Options {
+  uint64_t games;
+  uint32_t threads;
+  uint64_t seed;
+  uint8_t size;
+  uint8_t depth;
+  Policy policy;
+  const char *replay; // replay to verify instead of playing, NULL if none
+} Options;
+
+typedef struct GameResult {
+  uint64_t score;
+  uint32_t moves;
+  uint8_t maxExponent;
+} GameResult;
+
+typedef struct Worker {
+  pthread_t thread;
+  uint32_t id;
+  const Options *options;
+  random_engine_t *re;      // stream of the worker, forked from the seed
+  TranspositionTable table; // shared by the expectimax workers
+  GameResult *results;      // indexed by game, shared by all workers
+} Worker;
+
+// Snapshot of a game, used to try a move and roll it back
+typedef struct Snapshot {
+  Grid grid;
+  uint64_t score;
+} Snapshot;
+
+static uint32_t CpuCount(void) {
+#ifdef _WIN32
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors;
+#else
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (uint32_t)count : 1;
+#endif
+}
+
+static double Now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static inline void SnapshotSave(Snapshot *snapshot, Game game) {
+  GridCopy(snapshot->grid, game->grid);
+  snapshot->score = game->score;
+}
+
+static inline void SnapshotRestore(const Snapshot *snapshot, Game game) {
+  GridCopy(game->grid, snapshot->grid);
+  game->score = snapshot->score;
+}
+
+// Try a random direction, then the next ones until a move succeeds
+static bool MoveRandom(Game game, random_engine_t *re) {
+  int first = uniform_int_distribution(re, 0, 3);
+  for (int i = 0; i < 4; ++i) {
+    if (GameMove(game, (first + i) % 4, NULL)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Move in the direction that scores the most right away
+static bool MoveGreedy(Game game, Snapshot *snapshot) {
+  int best = -1;
+  uint64_t bestScore = 0;
+  SnapshotSave(snapshot, game);
+  for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+    // A move that fails leaves the game as it was
+    if (!GameMove(game, direction, NULL)) {
+      continue;
+    }
+    if (best == -1 || game->score > bestScore) {
+      best = direction;
+      bestScore = game->score;
+    }
+    SnapshotRestore(snapshot, game);
+  }
+  return best != -1 && GameMove(game, best, NULL);
+}
+
+// Keep the largest tiles in the bottom left corner
+static bool MoveCorner(Game game) {
+  static const Direction ORDER[] = {DOWN, LEFT, RIGHT, UP};
+  for (int i = 0; i < 4; ++i) {
+    if (GameMove(game, ORDER[i], NULL)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool MoveExpectimax(Game game, AiSolver solver) {
+  Direction direction;
+  return AiSolverBestMove(solver, game, &direction) &&
+         GameMove(game, direction, NULL);
+}
+
+static void *RunWorker(void *arg) {
+  Worker *worker = arg;
+  const Options *options = worker->options;
+  Snapshot snapshot = {NULL, 0};
+  GridInit(&snapshot.grid, options->size);
+  random_engine_t *re = worker->re;
+  AiSolver solver = NULL;
+  if (options->policy == POLICY_EXPECTIMAX) {
+    AiConfig config = AiDefaultConfig();
+    config.depth = options->depth;
+    config.table = worker->table;
+    AiSolverInit(&solver, &config);
+  }
+
+  // Games are dealt round-robin, a run is reproducible for a thread count
+  // A single game is reset for every game dealt, nothing is allocated
+  Game game;
+  GameInitWithSeed(&game, options->size, 0);
+  for (uint64_t i = worker->id; i < options->games; i += options->threads) {
+    xoshiro256ss_seed(&game->rng, random_engine_next(re));
+    GameReset(game);
+    for (;;) {
+      bool moved = false;
+      switch (options->policy) {
+      case POLICY_RANDOM:
+        moved = MoveRandom(game, re);
+        break;
+      case POLICY_GREEDY:
+        moved = MoveGreedy(game, &snapshot);
+        break;
+      case POLICY_CORNER:
+        moved = MoveCorner(game);
+        break;
+      case POLICY_EXPECTIMAX:
+        moved = MoveExpectimax(game, solver);
+        break;
+      }
+      if (!moved) {
+        break;
+      }
+      GameAddRandomTile(game);
+      ++game->moves;
+    }
+
+    GameResult *result = &worker->results[i];
+    result->score = game->score;
+    result->moves = game->moves;
+    result->maxExponent =
+        game->grid->maxTile ? __builtin_ctzll(game->grid->maxTile) : 0;
+  }
+  GameFree(&game);
+
+  if (solver) {
+    AiSolverFree(&solver);
+  }
+  GridFree(&snapshot.grid);
+  return NULL;
+}
+
+// Play a replay to its end and print the final state of its game
+static int VerifyReplay(const char *path) {
+  FILE *stream = fopen(path, "rb");
+  if (!stream) {
+    perror(path);
+    return 1;
+  }
+  double start = Now();
+  ReplayPlayer player;
+  bool loaded = ReplayPlayerLoad(&player, stream);
+  fclose(stream);
+  if (!loaded) {
+    fprintf(stderr, "%s: not a replay of this version\n", path);
+    return 1;
+  }
+  bool valid = ReplayPlayerRun(player);
+  double elapsed = Now() - start;
+  Game game = player->game;
+  uint64_t maxTile = game->grid->maxTile;
+  printf("replay: %s, grid: %ux%u, moves: %llu/%llu\n",
+         valid ? "valid" : "diverged", game->grid->size, game->grid->size,
+         (unsigned long long)player->played,
+         (unsigned long long)player->n_moves);
+  printf("score: %llu, max tile: %llu, time: %.3f ms\n",
+         (unsigned long long)game->score, (unsigned long long)maxTile,
+         elapsed * 1e3);
+  ReplayPlayerFree(&player);
+  return valid ? 0 : 2;
+}
+
+static int CompareScores(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t Percentile(const uint64_t *sorted, uint64_t n, double p) {
+  uint64_t index = (uint64_t)(p / 100.0 * (n - 1) + 0.5);
+  return sorted[index];
+}
+
+static void PrintUsage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -n GAMES    number of games to play (default: 1000)\n"
+          "  -p POLICY   random, greedy, corner or expectimax (default: "
+          "random)\n"
+          "  -t THREADS  number of worker threads (default: CPU count)\n"
+          "  -s SEED     seed of the engine forked for the workers (default: "
+          "1)\n"
+          "  -S SIZE     grid size (default: 4)\n"
+          "  -d DEPTH    expectimax search depth (default: 3)\n"
+          "  -r FILE     play a replay again and print its final state\n",
+          program);
+}
+
+static bool ParseOptions(int argc, char **argv, Options *options) {
+  for (int i = 1; i < argc; ++i) {
+    const char *arg = argv[i];
+    if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || i + 1 >= argc) {
+      return false;
+    }
+    const char *value = argv[++i];
+    char *end;
+    unsigned long long number = strtoull(value, &end, 10);
+    bool valid = *value != '\0' && *end == '\0';
+    switch (arg[1]) {
+    case 'n':
+      options->games = number;
+      break;
+    case 't':
+      options->threads = (uint32_t)number;
+      break;
+    case 's':
+      options->seed = number;
+      break;
+    case 'S':
+      if (number < 2 || number > UINT8_MAX) {
+        return false;
+      }
+      options->size = (uint8_t)number;
+      break;
+    case 'd':
+      if (number < 1 || number > 8) {
+        return false;
+      }
+      options->depth = (uint8_t)number;
+      break;
+    case 'r':
+      options->replay = value;
+      valid = true;
+      break;
+    case 'p':
+      valid = false;
+      for (size_t p = 0; p < POLICY_COUNT; ++p) {
+        if (strcmp(value, POLICY_NAMES[p]) == 0) {
+          options->policy = (Policy)p;
+          valid = true;
+        }
+      }
+      break;
+    default:
+      return false;
+    }
+    if (!valid) {
+      return false;
+    }
+  }
+  return options->games > 0 && options->threads > 0;
+}
+
+int main(int argc, char **argv) {
+  Options options = {
+      .games = 1000,
+      .threads = CpuCount(),
+      .seed = 1,
+      .size = 4,
+      .depth = 3,
+      .policy = POLICY_RANDOM,
+  };
+  if (!ParseOptions(argc, argv, &options)) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+  if (options.replay) {
+    return VerifyReplay(options.replay);
+  }
+  if (options.policy == POLICY_EXPECTIMAX && options.size != BITBOARD_SIZE) {
+    fprintf(stderr, "expectimax only plays on a %dx%d grid\n", BITBOARD_SIZE,
+            BITBOARD_SIZE);
+    return 1;
+  }
+  if (options.threads > options.games) {
+    options.threads = (uint32_t)options.games;
+  }
+
+  GameResult *results = calloc(options.games, sizeof(GameResult));
+  Worker *workers = calloc(options.threads, sizeof(Worker));
+  if (!results || !workers) {
+    fprintf(stderr, "failed to allocate %llu games\n",
+            (unsigned long long)options.games);
+    return 1;
+  }
+  TranspositionTable table = NULL;
+  if (options.policy == POLICY_EXPECTIMAX) {
+    TranspositionInit(&table, 22);
+    // The row tables are shared by the workers, build them before any starts
+    BitboardInit();
+  }
+
+  // Every worker draws its own stream, 2^128 numbers away from the others
+  random_engine_t *master = Xoshiro256ssEngine.ctor_seed(options.seed);
+  random_engine_t **engines = calloc(options.threads, sizeof(random_engine_t *));
+  if (!master || !engines ||
+      !Xoshiro256ssEngine.fork(master, engines, options.threads)) {
+    fprintf(stderr, "failed to create the random engines\n");
+    return 1;
+  }
+  random_engine_dtor(master);
+
+  double start = Now();
+  for (uint32_t i = 0; i < options.threads; ++i) {
+    workers[i].id = i;
+    workers[i].re = engines[i];
+    workers[i].options = &options;
+    workers[i].table = table;
+    workers[i].results = results;
+    if (pthread_create(&workers[i].thread, NULL, RunWorker, &workers[i])) {
+      perror("pthread_create");
+      return 1;
+    }
+  }
+  for (uint32_t i = 0; i < options.threads; ++i) {
+    pthread_join(workers[i].thread, NULL);
+    random_engine_dtor(engines[i]);
+  }
+  free(engines);
+  double elapsed = Now() - start;
+
+  uint64_t *scores = calloc(options.games, sizeof(uint64_t));
+  if (!scores) {
+    fprintf(stderr, "failed to allocate %llu scores\n",
+            (unsigned long long)options.games);
+    return 1;
+  }
+  uint64_t histogram[MAX_EXPONENT] = {0};
+  uint64_t totalMoves = 0, totalScore = 0;
+  for (uint64_t i = 0; i < options.games; ++i) {
+    scores[i] = results[i].score;
+    totalScore += results[i].score;
+    totalMoves += results[i].moves;
+    ++histogram[results[i].maxExponent];
+  }
+  qsort(scores, options.games, sizeof(uint64_t), CompareScores);
+
+  printf("policy: %s, grid: %ux%u, games: %llu, threads: %u, seed: %llu\n",
+         POLICY_NAMES[options.policy], options.size, options.size,
+         (unsigned long long)options.games, options.threads,
+         (unsigned long long)options.seed);
+  printf("time: %.3f s, moves: %llu, moves/sec: %.0f, games/sec: %.1f\n",
+         elapsed, (unsigned long long)totalMoves, totalMoves / elapsed,
+         options.games / elapsed);
+  printf("score: mean %.1f, min %llu, p25 %llu, p50 %llu, p75 %llu, "
+         "p90 %llu, p99 %llu, max %llu\n",
+         (double)totalScore / options.games, (unsigned long long)scores[0],
+         (unsigned long long)Percentile(scores, options.games, 25),
+         (unsigned long long)Percentile(scores, options.games, 50),
+         (unsigned long long)Percentile(scores, options.games, 75),
+         (unsigned long long)Percentile(scores, options.games, 90),
+         (unsigned long long)Percentile(scores, options.games, 99),
+         (unsigned long long)scores[options.games - 1]);
+  printf("max tile:\n");
+  for (int exponent = 0; exponent < MAX_EXPONENT; ++exponent) {
+    if (histogram[exponent]) {
+      printf("  %20llu: %llu (%.2f%%)\n", 1ULL << exponent,
+             (unsigned long long)histogram[exponent],
+             100.0 * histogram[exponent] / options.games);
+    }
+  }
+  if (table) {
+    TranspositionStats stats = TranspositionGetStats(table);
+    printf("transposition table: %llu probes, %.1f%% hits\n",
+           (unsigned long long)stats.probes,
+           stats.probes ? 100.0 * stats.hits / stats.probes : 0.0);
+    TranspositionFree(&table);
+  }
+
+  free(scores);
+  free(workers);
+  free(results);
+  return 0;
+}
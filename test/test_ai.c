@@ -0,0 +1,56 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "core/ai.h"
+#include "core/bitboard.h"
+#include "core/game.h"
+#include "random.h"
+
+int main(void) {
+  AiSolver solver;
+  AiConfig config = AiDefaultConfig();
+  // TEST INITIALIZATION
+  AiSolverInit(&solver, &config);
+  assert(solver);
+  assert(solver->config.depth == 3);
+  assert(solver->lineScores);
+  // END TEST INITIALIZATION
+
+  // TEST no move available
+  Direction direction;
+  assert(!AiSolverBestMoveBitboard(solver, 0x1212212112122121ULL, &direction));
+  // END TEST no move available
+
+  // TEST single move available
+  // 2 4 2 4 / 4 2 4 2 / 2 4 2 4 / 4 2 4 0: only RIGHT and DOWN move
+  Bitboard board = 0x0212212112122121ULL;
+  assert(AiSolverBestMoveBitboard(solver, board, &direction));
+  assert(direction == RIGHT || direction == DOWN);
+  // END TEST single move available
+
+  // TEST play a game
+  Game game;
+  GameInit(&game, 4);
+  xoshiro256ss_seed(&game->rng, 2048);
+  uint16_t diff[16];
+  uint64_t maxTile = 0;
+  while (AiSolverBestMove(solver, game, &direction)) {
+    assert(GameMove(game, direction, diff));
+    GameAddRandomTile(game);
+    ++game->moves;
+  }
+  for (uint16_t i = 0; i < game->grid->length; ++i) {
+    if (game->grid->cells[i] > maxTile) {
+      maxTile = game->grid->cells[i];
+    }
+  }
+  assert(maxTile >= 512);
+  GameFree(&game);
+  // END TEST play a game
+
+  // TEST Free
+  AiSolverFree(&solver);
+  assert(solver == NULL);
+  // END TEST Free
+}
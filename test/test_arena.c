@@ -0,0 +1,46 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "core/arena.h"
+
+int main(void) {
+  Arena arena;
+  // TEST INITIALIZATION
+  assert(ArenaInit(&arena, 100));
+  assert(arena->capacity >= 100 && arena->used == 0);
+  assert((uintptr_t)arena->base % ARENA_ALIGNMENT == 0);
+  // END TEST INITIALIZATION
+
+  // TEST ArenaAlloc
+  uint8_t *a = ArenaAlloc(arena, 1);
+  uint8_t *b = ArenaAlloc(arena, 17);
+  assert(a == arena->base);
+  assert(b == a + ARENA_ALIGNMENT);
+  assert((uintptr_t)b % ARENA_ALIGNMENT == 0);
+  size_t mark = arena->used;
+  assert(mark == 3 * ARENA_ALIGNMENT);
+  // Blocks are writable up to their size
+  for (int i = 0; i < 17; ++i) {
+    b[i] = i;
+  }
+  assert(ArenaAlloc(arena, arena->capacity) == NULL);
+  assert(ArenaAlloc(arena, SIZE_MAX) == NULL);
+  assert(arena->used == mark);
+  // END TEST ArenaAlloc
+
+  // TEST ArenaRewind
+  uint8_t *c = ArenaAlloc(arena, 8);
+  assert(c == arena->base + mark);
+  ArenaRewind(arena, mark);
+  assert(ArenaAlloc(arena, 8) == c);
+  ArenaRewind(arena, 0);
+  assert(arena->used == 0);
+  assert(ArenaAlloc(arena, 1) == a);
+  // END TEST ArenaRewind
+
+  // TEST ArenaFree
+  ArenaFree(&arena);
+  assert(arena == NULL);
+  // END TEST ArenaFree
+}
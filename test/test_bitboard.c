@@ -0,0 +1,75 @@
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "core/bitboard.h"
+#include "core/game.h"
+#include "core/grid.h"
+#include "random.h"
+
+int main(void) {
+  BitboardInit();
+
+  // TEST packing
+  Grid grid;
+  GridInit(&grid, 4);
+  uint64_t gridCells[16] = {2, 0, 0, 2, 0, 2, 2, 0, 0, 0, 0, 32768, 0, 0, 0, 4};
+  memcpy(grid->cells, gridCells, 16 * sizeof(uint64_t));
+  Bitboard board;
+  assert(BitboardFromGrid(grid, &board));
+  assert(BitboardGetCell(board, 0) == 1);
+  assert(BitboardGetCell(board, 1) == 0);
+  assert(BitboardGetCell(board, 11) == 15);
+  assert(BitboardGetCell(board, 15) == 2);
+  assert(BitboardCountEmpty(board) == 10);
+  BitboardToGrid(board, grid);
+  assert(memcmp(grid->cells, gridCells, 16 * sizeof(uint64_t)) == 0);
+  grid->cells[3] = 65536;
+  assert(!BitboardFromGrid(grid, &board));
+  GridFree(&grid);
+  // END TEST packing
+
+  // TEST moves and spawns match GameMove and GameAddRandomTile
+  random_engine_t *directions = Xoshiro256ssEngine.ctor_seed(2048);
+  for (uint64_t seed = 1; seed <= 32; ++seed) {
+    Game game;
+    GameInit(&game, 4);
+    xoshiro256ss_seed(&game->rng, seed);
+    random_engine_t *re = Xoshiro256ssEngine.ctor_seed(seed);
+    uint16_t diff[16];
+    uint64_t score = 0;
+    assert(BitboardFromGrid(game->grid, &board));
+
+    while (GridAnyCellAvailable(game->grid) || GameTileMatchesAvailable(game)) {
+      assert(BitboardTileMatchesAvailable(board) ==
+             GameTileMatchesAvailable(game));
+      Direction direction = uniform_int_distribution(directions, 0, 3);
+      bool moved = GameMove(game, direction, diff);
+      assert(BitboardMove(&board, direction, &score) == moved);
+      assert(score == game->score);
+      if (moved) {
+        assert(BitboardAddRandomTile(&board, re) == GameAddRandomTile(game));
+      }
+      Bitboard expected;
+      if (!BitboardFromGrid(game->grid, &expected)) {
+        break; // tile too large for a bitboard
+      }
+      assert(board == expected);
+    }
+
+    random_engine_dtor(re);
+    GameFree(&game);
+  }
+  random_engine_dtor(directions);
+  // END TEST moves and spawns match GameMove and GameAddRandomTile
+
+  // TEST full board
+  board = 0x1212212112122121ULL;
+  assert(BitboardCountEmpty(board) == 0);
+  assert(!BitboardTileMatchesAvailable(board));
+  assert(BitboardAddRandomTile(&board, NULL) == -1);
+  for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+    assert(!BitboardMove(&board, direction, NULL));
+  }
+  // END TEST full board
+}
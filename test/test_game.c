@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "core/game.h"
@@ -34,6 +35,22 @@ void printDiff(const uint16_t * expected, const uint16_t * actual, uint8_t size)
     puts("-----------------------------");
 }
 
+// Check that the summary kept by the grid matches its cells
+void assertSynced(Grid grid) {
+  size_t words = GRID_EMPTY_WORDS(grid->length);
+  uint64_t *empty = malloc(words * sizeof(uint64_t));
+  memcpy(empty, grid->empty, words * sizeof(uint64_t));
+  uint16_t n_empty = grid->n_empty;
+  uint64_t maxTile = grid->maxTile;
+  bool hasPair = GridHasPair(grid);
+  GridSync(grid);
+  assert(memcmp(empty, grid->empty, words * sizeof(uint64_t)) == 0);
+  assert(n_empty == grid->n_empty);
+  assert(maxTile == grid->maxTile);
+  assert(hasPair == GridHasPair(grid));
+  free(empty);
+}
+
 int main(void) {
   Game game;
   // TEST INITIALIZATION
@@ -43,7 +60,7 @@ int main(void) {
   assert(game->grid->size == 4);
   assert(game->grid->length == 16);
   assert(game->grid->cells);
-  assert(game->re);
+  assert(!game->re); // tiles are drawn from the embedded engine
   assert(game->score == 0);
   assert(game->moves == 0);
   uint16_t available[16];
@@ -65,6 +82,7 @@ int main(void) {
   Direction direction = LEFT;
   uint16_t diff[16];
   memcpy(game->grid->cells, gridCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
   assert(memcmp(game->grid->cells, gridCells, 16 * sizeof(uint64_t)) == 0);
   GameMove(game, direction, diff);
   assert(memcmp(game->grid->cells, expectedGridCells[direction],
@@ -74,6 +92,7 @@ int main(void) {
 
   direction = UP;
   memcpy(game->grid->cells, gridCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
   GameMove(game, direction, diff);
   assert(memcmp(game->grid->cells, expectedGridCells[direction],
                 16 * sizeof(uint64_t)) == 0);
@@ -82,6 +101,7 @@ int main(void) {
 
   direction = RIGHT;
   memcpy(game->grid->cells, gridCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
   GameMove(game, direction, diff);
   assert(memcmp(game->grid->cells, expectedGridCells[direction],
                 16 * sizeof(uint64_t)) == 0);
@@ -90,12 +110,199 @@ int main(void) {
 
   direction = DOWN;
   memcpy(game->grid->cells, gridCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
   GameMove(game, direction, diff);
   assert(memcmp(game->grid->cells, expectedGridCells[direction],
                 16 * sizeof(uint64_t)) == 0);
   printDiff(expectedDiff[direction], diff, 4);
   assert(memcmp(diff, expectedDiff[direction], 16 * sizeof(uint16_t)) == 0);
 
+  // TEST moves past empty cells
+  // Tiles landing on cells other tiles moved away from keep their own target
+  const uint64_t gapCells[16] = {0, 2, 0, 4, 2, 2, 4, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  const uint64_t expectedGapCells[16] = {2, 4, 0, 0, 4, 4, 0, 0,
+                                         0, 0, 0, 0, 0, 0, 0, 0};
+  const uint16_t expectedGapDiff[16] = {0, 0, 2,  1,  4,  4,  5,  7,
+                                        8, 9, 10, 11, 12, 13, 14, 15};
+  memcpy(game->grid->cells, gapCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
+  game->score = 0;
+  assert(GameMove(game, LEFT, diff));
+  assert(memcmp(game->grid->cells, expectedGapCells, 16 * sizeof(uint64_t)) ==
+         0);
+  printDiff(expectedGapDiff, diff, 4);
+  assert(memcmp(diff, expectedGapDiff, 16 * sizeof(uint16_t)) == 0);
+  assert(game->score == 4);
+  // END TEST moves past empty cells
+
+  // TEST GameMoveTrace
+  const TileMove expectedTrace[] = {
+      {1, 0, false, 2}, {3, 1, false, 4}, {4, 4, true, 4},
+      {5, 4, true, 4},  {6, 5, false, 4},
+  };
+  TileMove trace[16];
+  uint16_t n_trace;
+  memcpy(game->grid->cells, gapCells, 16 * sizeof(uint64_t));
+  GridSync(game->grid);
+  assert(GameMoveTrace(game, LEFT, trace, &n_trace));
+  assert(memcmp(game->grid->cells, expectedGapCells, 16 * sizeof(uint64_t)) ==
+         0);
+  assert(n_trace == 5);
+  for (uint16_t i = 0; i < n_trace; ++i) {
+    assert(trace[i].from == expectedTrace[i].from);
+    assert(trace[i].to == expectedTrace[i].to);
+    assert(trace[i].merged == expectedTrace[i].merged);
+    assert(trace[i].value == expectedTrace[i].value);
+  }
+  memcpy(game->grid->cells, expectedGridCells[LEFT], 16 * sizeof(uint64_t));
+  GridSync(game->grid);
+  assert(!GameMoveTrace(game, LEFT, trace, &n_trace));
+  assert(n_trace == 0);
+  // END TEST GameMoveTrace
+
+  // TEST large grids
+  // Vertical moves must match horizontal moves on the transposed grid
+  const uint8_t largeSizes[] = {15, 16, 64, 255};
+  for (size_t s = 0; s < sizeof(largeSizes) / sizeof(largeSizes[0]); ++s) {
+    Game large, transposed;
+    uint8_t size = largeSizes[s];
+    GameInit(&large, size);
+    GameInit(&transposed, size);
+    uint16_t length = large->grid->length;
+    assert(length == (uint16_t)size * size);
+    uint16_t *largeDiff = malloc(length * sizeof(uint16_t));
+    uint16_t *transposedDiff = malloc(length * sizeof(uint16_t));
+    for (Direction vertical = UP; vertical <= DOWN; vertical += 2) {
+      for (uint16_t i = 0; i < length; ++i) {
+        uint64_t value = xoshiro256ss_step(&large->rng) % 4;
+        value = value ? (uint64_t)1 << value : 0;
+        large->grid->cells[i] = value;
+        transposed->grid->cells[(i % size) * size + i / size] = value;
+      }
+      GridSync(large->grid);
+      GridSync(transposed->grid);
+      large->score = transposed->score = 0;
+      assert(GameMove(large, vertical, largeDiff));
+      assert(GameMove(transposed, vertical - 1, transposedDiff));
+      assert(large->score == transposed->score);
+      assertSynced(large->grid);
+      for (uint16_t i = 0; i < length; ++i) {
+        uint16_t t = (i % size) * size + i / size;
+        assert(large->grid->cells[i] == transposed->grid->cells[t]);
+        uint16_t to = transposedDiff[t];
+        assert(largeDiff[i] == (to % size) * size + to / size);
+      }
+    }
+    // Moves without a diff must match moves with one
+    for (Direction direction = LEFT; direction <= DOWN; ++direction) {
+      for (uint16_t i = 0; i < length; ++i) {
+        uint64_t value = xoshiro256ss_step(&large->rng) % 4;
+        large->grid->cells[i] = value ? (uint64_t)1 << value : 0;
+      }
+      GridSync(large->grid);
+      memcpy(transposed->grid->cells, large->grid->cells,
+             length * sizeof(uint64_t));
+      GridSync(transposed->grid);
+      large->score = transposed->score = 0;
+      assert(GameMove(large, direction, NULL));
+      assert(GameMove(transposed, direction, transposedDiff));
+      assert(large->score == transposed->score);
+      assert(memcmp(large->grid->cells, transposed->grid->cells,
+                    length * sizeof(uint64_t)) == 0);
+      assertSynced(large->grid);
+      assertSynced(transposed->grid);
+    }
+    // Fill the whole grid, then check that no tile can be added anymore
+    memset(large->grid->cells, 0, length * sizeof(uint64_t));
+    GridSync(large->grid);
+    assert(GameAddRandomTiles(large, length));
+    assert(!GridAnyCellAvailable(large->grid));
+    assertSynced(large->grid);
+    assert(GameAddRandomTile(large) == -1);
+    assert(!GameAddRandomTiles(large, 1));
+    free(transposedDiff);
+    free(largeDiff);
+    GameFree(&transposed);
+    GameFree(&large);
+  }
+  // END TEST large grids
+
+  // TEST GameInitWithSeed
+  // The embedded engine deals the same tiles as an engine with the same seed
+  Game seeded, engined;
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+  GameInitWithSeed(&seeded, 8, 2048);
+  GameInitWithEngine(&engined, 8, re);
+  assert(!seeded->re && engined->re == re);
+  assert(GameAddRandomTiles(seeded, 40));
+  assert(GameAddRandomTiles(engined, 40));
+  assert(memcmp(seeded->grid->cells, engined->grid->cells,
+                64 * sizeof(uint64_t)) == 0);
+  assert(xoshiro256ss_step(&seeded->rng) == random_engine_next(re));
+  GameFree(&engined);
+  GameFree(&seeded);
+  random_engine_dtor(re); // not released by GameFree
+  // END TEST GameInitWithSeed
+
+  // TEST GameReset
+  // A reset game with the same seed deals the tiles of a new game
+  GameInitWithSeed(&seeded, 4, 99);
+  assert(GameMove(seeded, LEFT, NULL) || GameMove(seeded, RIGHT, NULL));
+  seeded->moves = 3;
+  Grid grid = seeded->grid;
+  uint64_t *cells = grid->cells;
+  xoshiro256ss_seed(&seeded->rng, 7);
+  GameReset(seeded);
+  Game fresh;
+  GameInitWithSeed(&fresh, 4, 7);
+  assert(seeded->grid == grid && seeded->grid->cells == cells);
+  assert(seeded->score == 0 && seeded->moves == 0);
+  assert(memcmp(seeded->grid->cells, fresh->grid->cells,
+                16 * sizeof(uint64_t)) == 0);
+  uint64_t dealt[16];
+  memcpy(dealt, fresh->grid->cells, sizeof(dealt));
+  GameFree(&fresh);
+  GameFree(&seeded);
+  // END TEST GameReset
+
+  // TEST GameInitIn
+  Arena arena;
+  assert(ArenaInit(&arena, 2 * GameFootprint(8)));
+  Game first, second, third;
+  assert(GameInitIn(&first, arena, 8, 2048));
+  assert(GameInitIn(&second, arena, 8, 2048));
+  assert(!GameInitIn(&third, arena, 8, 2048));
+  assert(third == NULL);
+  assert(first->grid->length == 64 && !first->re);
+  assert(GridCountAvailableCells(first->grid) == 62);
+  assert(memcmp(first->grid->cells, second->grid->cells,
+                64 * sizeof(uint64_t)) == 0);
+  // Rewinding takes the games back
+  ArenaRewind(arena, 0);
+  assert(GameInitIn(&third, arena, 8, 1));
+  assert(third == first);
+  ArenaFree(&arena);
+  // END TEST GameInitIn
+
+  // TEST GamePool
+  GamePool pool;
+  assert(GamePoolInit(&pool, 4, 3));
+  Game games[3];
+  for (int i = 0; i < 3; ++i) {
+    games[i] = GamePoolAcquire(pool, 7);
+    assert(games[i] && games[i]->grid->size == 4);
+    assert(memcmp(games[i]->grid->cells, dealt, sizeof(dealt)) == 0);
+  }
+  assert(GamePoolAcquire(pool, 7) == NULL);
+  games[1]->score = 1024;
+  GamePoolRelease(pool, games[1]);
+  Game again = GamePoolAcquire(pool, 8);
+  assert(again == games[1] && again->score == 0 && again->moves == 0);
+  assert(GridCountAvailableCells(again->grid) == 14);
+  GamePoolFree(&pool);
+  assert(pool == NULL);
+  // END TEST GamePool
+
   // TEST Free
   GameFree(&game);
   assert(game == NULL);
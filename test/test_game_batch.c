@@ -0,0 +1,197 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/game.h"
+#include "core/game_batch.h"
+#include "core/grid.h"
+#include "random.h"
+
+static uint16_t CountTiles(const uint64_t *cells, uint16_t length) {
+  uint16_t tiles = 0;
+  for (uint16_t i = 0; i < length; ++i) {
+    tiles += cells[i] != 0;
+  }
+  return tiles;
+}
+
+int main(void) {
+  GameBatch batch;
+  // TEST INITIALIZATION
+  assert(!GameBatchInit(&batch, GAME_BATCH_MAX_SIZE + 1, 8, 1));
+  assert(batch == NULL);
+  assert(!GameBatchInit(&batch, 4, 0, 1));
+  assert(GameBatchInit(&batch, 4, 100, 2048));
+  assert(batch->length == 16);
+  assert(batch->stride >= batch->count && batch->stride % GAME_BATCH_BLOCK == 0);
+  assert((uintptr_t)batch->cells % 64 == 0);
+  uint64_t cells[GAME_BATCH_MAX_SIZE * GAME_BATCH_MAX_SIZE];
+  for (uint32_t b = 0; b < batch->count; ++b) {
+    GameBatchGetBoard(batch, b, cells);
+    assert(CountTiles(cells, 16) == 2);
+    assert(batch->score[b] == 0 && batch->moves[b] == 0);
+  }
+  // Boards draw different streams
+  GameBatchGetBoard(batch, 0, cells);
+  uint64_t other[16];
+  bool differ = false;
+  for (uint32_t b = 1; b < batch->count && !differ; ++b) {
+    GameBatchGetBoard(batch, b, other);
+    differ = memcmp(cells, other, sizeof(other)) != 0;
+  }
+  assert(differ);
+  GameBatchFree(&batch);
+  assert(batch == NULL);
+  // END TEST INITIALIZATION
+
+  // TEST GameBatchMove matches GameMove
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(7);
+  const uint8_t sizes[] = {2, 3, 4, 5, 8, GAME_BATCH_MAX_SIZE};
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    uint8_t size = sizes[s];
+    uint32_t count = 200;
+    assert(GameBatchInit(&batch, size, count, s));
+    uint16_t length = batch->length;
+    Game *games = malloc(count * sizeof(Game));
+    Direction *directions = malloc(count * sizeof(Direction));
+    bool *moved = malloc(count * sizeof(bool));
+    for (uint32_t b = 0; b < count; ++b) {
+      GameInitWithSeed(&games[b], size, b);
+    }
+    for (int round = 0; round < 20; ++round) {
+      for (uint32_t b = 0; b < count; ++b) {
+        // Few distinct values, for many merges
+        for (uint16_t i = 0; i < length; ++i) {
+          uint64_t value = random_engine_next(re) % 4;
+          games[b]->grid->cells[i] = value ? (uint64_t)1 << value : 0;
+        }
+        GridSync(games[b]->grid);
+        GameBatchSetBoard(batch, b, games[b]->grid->cells);
+        directions[b] = bounded_int_distribution(re, 4);
+      }
+      uint32_t n_moved = GameBatchMove(batch, directions, moved);
+      uint32_t expectedMoved = 0;
+      for (uint32_t b = 0; b < count; ++b) {
+        bool expected = GameMove(games[b], directions[b], NULL);
+        expectedMoved += expected;
+        assert(moved[b] == expected);
+        assert(batch->score[b] == games[b]->score);
+        assert(batch->moves[b] == games[b]->moves + expected);
+        games[b]->moves += expected;
+        GameBatchGetBoard(batch, b, cells);
+        assert(memcmp(cells, games[b]->grid->cells,
+                      length * sizeof(uint64_t)) == 0);
+      }
+      assert(n_moved == expectedMoved);
+    }
+    for (uint32_t b = 0; b < count; ++b) {
+      GameFree(&games[b]);
+    }
+    free(moved);
+    free(directions);
+    free(games);
+    GameBatchFree(&batch);
+  }
+  // END TEST GameBatchMove matches GameMove
+
+  // TEST GameBatchSpawn
+  assert(GameBatchInit(&batch, 4, 1000, 9));
+  bool *mask = malloc(batch->count * sizeof(bool));
+  uint64_t full[16];
+  for (uint16_t i = 0; i < 16; ++i) {
+    full[i] = 2 << (i % 2); // no match either
+  }
+  GameBatchSetBoard(batch, 0, full);
+  for (uint32_t b = 0; b < batch->count; ++b) {
+    mask[b] = b % 2 == 0;
+  }
+  assert(GameBatchSpawn(batch, mask) == batch->count / 2 - 1);
+  uint32_t fours = 0, tiles = 0, positions[16] = {0};
+  for (int round = 0; round < 10; ++round) {
+    for (uint32_t b = 1; b < batch->count; ++b) {
+      uint64_t before[16];
+      GameBatchGetBoard(batch, b, before);
+      GameBatchReset(batch, b);
+      GameBatchGetBoard(batch, b, cells);
+      assert(CountTiles(cells, 16) == 2);
+      GameBatchSetBoard(batch, b, before);
+    }
+    for (uint32_t b = 0; b < batch->count; ++b) {
+      mask[b] = true;
+    }
+    uint64_t before[16];
+    GameBatchGetBoard(batch, 1, before);
+    assert(GameBatchSpawn(batch, NULL) == batch->count - 1);
+    for (uint32_t b = 1; b < batch->count; ++b) {
+      GameBatchGetBoard(batch, b, cells);
+      if (b == 1) {
+        uint16_t changed = 0;
+        for (uint16_t i = 0; i < 16; ++i) {
+          if (cells[i] != before[i]) {
+            assert(before[i] == 0 && (cells[i] == 2 || cells[i] == 4));
+            ++changed;
+          }
+        }
+        assert(changed == 1);
+      }
+    }
+    // Empty the boards but one tile, to check the spread of the spawns
+    for (uint32_t b = 1; b < batch->count; ++b) {
+      memset(cells, 0, sizeof(full));
+      GameBatchSetBoard(batch, b, cells);
+    }
+    assert(GameBatchSpawn(batch, mask) == batch->count - 1);
+    for (uint32_t b = 1; b < batch->count; ++b) {
+      GameBatchGetBoard(batch, b, cells);
+      for (uint16_t i = 0; i < 16; ++i) {
+        if (cells[i]) {
+          ++positions[i];
+          fours += cells[i] == 4;
+          ++tiles;
+        }
+      }
+    }
+  }
+  assert(tiles == 10 * (batch->count - 1));
+  assert(fours > tiles / 20 && fours < tiles * 3 / 20);
+  for (uint16_t i = 0; i < 16; ++i) {
+    assert(positions[i] > tiles / 32 && positions[i] < tiles / 8);
+  }
+  free(mask);
+  GameBatchFree(&batch);
+  // END TEST GameBatchSpawn
+
+  // TEST GameBatchAlive matches the game over check of Game
+  assert(GameBatchInit(&batch, 4, 500, 3));
+  bool *alive = malloc(batch->count * sizeof(bool));
+  Game game;
+  GameInitWithSeed(&game, 4, 3);
+  for (int round = 0; round < 10; ++round) {
+    uint32_t expectedAlive = 0;
+    for (uint32_t b = 0; b < batch->count; ++b) {
+      // Mostly full boards of few values
+      for (uint16_t i = 0; i < 16; ++i) {
+        uint64_t value = random_engine_next(re) % 17;
+        game->grid->cells[i] = value ? (uint64_t)1 << value : 0;
+      }
+      GridSync(game->grid);
+      GameBatchSetBoard(batch, b, game->grid->cells);
+      expectedAlive += GridAnyCellAvailable(game->grid) ||
+                       GameTileMatchesAvailable(game);
+    }
+    uint32_t n_alive = GameBatchAlive(batch, alive);
+    assert(n_alive == expectedAlive);
+    for (uint32_t b = 0; b < batch->count; ++b) {
+      GameBatchGetBoard(batch, b, game->grid->cells);
+      GridSync(game->grid);
+      assert(alive[b] == (GridAnyCellAvailable(game->grid) ||
+                          GameTileMatchesAvailable(game)));
+    }
+  }
+  GameFree(&game);
+  free(alive);
+  GameBatchFree(&batch);
+  // END TEST GameBatchAlive matches the game over check of Game
+  random_engine_dtor(re);
+}
@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 #include "core/grid.h"
 
@@ -36,6 +37,7 @@ int main(void) {
     for (uint16_t i = 0; i < grid->length; ++i) {
         grid->cells[i] = 2;
     }
+    GridSync(grid);
     // check if cells are available
     // all cells should be unavailable
     for (uint16_t i = 0; i < grid->length; ++i) {
@@ -43,6 +45,67 @@ int main(void) {
     }
     // END TEST filling cells and checking if they are available
 
+    // TEST GridCountAvailableCells and GridGetNthAvailableCell
+    assert(GridCountAvailableCells(grid) == 0);
+    grid->cells[3] = 0;
+    grid->cells[9] = 0;
+    grid->cells[15] = 0;
+    GridSync(grid);
+    assert(GridCountAvailableCells(grid) == 3);
+    assert(GridGetNthAvailableCell(grid, 0) == 3);
+    assert(GridGetNthAvailableCell(grid, 1) == 9);
+    assert(GridGetNthAvailableCell(grid, 2) == 15);
+    // END TEST GridCountAvailableCells and GridGetNthAvailableCell
+
+    // TEST GridSetCell keeps the summary of the grid
+    assert(grid->n_empty == 3 && grid->maxTile == 2);
+    assert(GridHasPair(grid));
+    for (uint16_t i = 0; i < grid->length; ++i) {
+        GridSetCell(grid, i, (uint64_t) 2 << (i % 2 + (i / 4) % 2 * 2));
+    }
+    assert(!GridAnyCellAvailable(grid) && grid->maxTile == 16);
+    assert(!GridHasPair(grid));
+    GridSetCell(grid, 5, 0);
+    GridSetCell(grid, 6, 0);
+    assert(GridCountAvailableCells(grid) == 2);
+    assert(GridGetNthAvailableCell(grid, 1) == 6);
+    assert(!GridHasPair(grid));
+    GridSetCell(grid, 5, 2); // no neighbor holds a 2
+    assert(!GridHasPair(grid));
+    GridSetCell(grid, 6, 16); // next to the 16 at index 7
+    assert(GridHasPair(grid));
+    GridSetCell(grid, 6, 0);
+    assert(!GridHasPair(grid));
+    // The largest tiles shrink one at a time
+    for (uint16_t i = 0; i < grid->length; ++i) {
+        if (grid->cells[i] == 16) {
+            GridSetCell(grid, i, 2);
+        }
+    }
+    assert(grid->maxTile == 8);
+    // END TEST GridSetCell keeps the summary of the grid
+
+    // TEST large grid
+    Grid large;
+    GridInit(&large, 255);
+    assert(large->length == 65025);
+    assert(GridCountAvailableCells(large) == 65025);
+    assert(GridGetNthAvailableCell(large, 65024) == 65024);
+    // Picking and listing the available cells across the words of the bitmap
+    for (uint16_t i = 0; i < large->length; i += 3) {
+        GridSetCell(large, i, 2);
+    }
+    assert(GridCountAvailableCells(large) == 65025 - 21675);
+    uint16_t * cells = malloc(large->length * sizeof(uint16_t));
+    assert(GridGetAvailableCells(large, cells, large->length) == 43350);
+    for (uint16_t n = 0; n < 43350; ++n) {
+        assert(cells[n] == n / 2 * 3 + 1 + n % 2);
+        assert(GridGetNthAvailableCell(large, n) == cells[n]);
+    }
+    free(cells);
+    GridFree(&large);
+    // END TEST large grid
+
     // TEST GridFree
     GridFree(&grid);
     assert(grid == NULL);
@@ -0,0 +1,134 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/game.h"
+#include "core/history.h"
+
+#define MOVES 500
+#define CAPACITY 100
+
+// State of a game after every move, to compare undone states with
+typedef struct Snapshot {
+  uint64_t cells[64];
+  uint64_t score;
+  uint32_t moves;
+  uint16_t n_empty;
+  uint64_t maxTile;
+} Snapshot;
+
+static void Take(Game game, Snapshot *snapshot) {
+  memcpy(snapshot->cells, game->grid->cells, sizeof(snapshot->cells));
+  snapshot->score = game->score;
+  snapshot->moves = game->moves;
+  snapshot->n_empty = game->grid->n_empty;
+  snapshot->maxTile = game->grid->maxTile;
+}
+
+static bool Matches(Game game, const Snapshot *snapshot) {
+  return memcmp(snapshot->cells, game->grid->cells,
+                sizeof(snapshot->cells)) == 0 &&
+         snapshot->score == game->score && snapshot->moves == game->moves &&
+         snapshot->n_empty == game->grid->n_empty &&
+         snapshot->maxTile == game->grid->maxTile;
+}
+
+// Play a move and spawn a tile like the game loop does
+static void Play(Game game, random_engine_t *re) {
+  while (!GameMove(game, bounded_int_distribution(re, 4), NULL)) {
+    // Large grids do not fill up within the moves of the test
+  }
+  GameAddRandomTile(game);
+  ++game->moves;
+}
+
+int main(void) {
+  // TEST HistoryInit
+  History history;
+  assert(HistoryInit(&history, 16, 40));
+  assert(history->capacity == 2 * HISTORY_KEYFRAME_INTERVAL);
+  assert(history->position == 0 && history->end == 0);
+  HistoryFree(&history);
+  assert(history == NULL);
+  // END TEST HistoryInit
+
+  // TEST HistoryRecordSpawn
+  // A spawn joins the move before it, a second one gets a delta of its own
+  assert(HistoryInit(&history, 16, 64));
+  HistoryRecordMove(history, LEFT);
+  HistoryRecordSpawn(history, 3, 1);
+  HistoryRecordSpawn(history, 5, 2);
+  assert(history->end == 2);
+  const HistoryDelta *delta = HistoryDeltaAt(history, 0);
+  assert(delta->direction == LEFT && delta->spawnIndex == 3 &&
+         delta->spawnExponent == 1);
+  delta = HistoryDeltaAt(history, 1);
+  assert(delta->direction == HISTORY_NO_MOVE && delta->spawnIndex == 5 &&
+         delta->spawnExponent == 2);
+  HistoryFree(&history);
+  // END TEST HistoryRecordSpawn
+
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+  Snapshot *snapshots = malloc((MOVES + 1) * sizeof(Snapshot));
+
+  // TEST GameUndo and GameRedo without history
+  Game game;
+  GameInitWithSeed(&game, 8, 1);
+  assert(!GameUndo(game) && !GameRedo(game));
+  // END TEST GameUndo and GameRedo without history
+
+  // TEST GameUndo
+  assert(GameRecordHistory(game, CAPACITY));
+  uint32_t capacity = game->history->capacity;
+  Take(game, &snapshots[0]);
+  for (uint32_t m = 1; m <= MOVES; ++m) {
+    Play(game, re);
+    Take(game, &snapshots[m]);
+  }
+  // Every kept state is restored, from the last one back to the oldest
+  uint64_t end = game->history->end;
+  uint64_t undone = 0;
+  while (GameUndo(game)) {
+    ++undone;
+    assert(Matches(game, &snapshots[MOVES - undone]));
+  }
+  assert(undone <= capacity && undone + HISTORY_KEYFRAME_INTERVAL > capacity);
+  assert(game->history->position == game->history->first);
+  // END TEST GameUndo
+
+  // TEST GameRedo
+  for (uint64_t redone = 1; redone <= undone; ++redone) {
+    assert(GameRedo(game));
+    assert(Matches(game, &snapshots[MOVES - undone + redone]));
+  }
+  assert(!GameRedo(game));
+  assert(game->history->end == end);
+  // A new move drops the states that could be redone
+  for (int i = 0; i < 40; ++i) {
+    assert(GameUndo(game));
+  }
+  Take(game, &snapshots[0]);
+  Play(game, re);
+  assert(!GameRedo(game));
+  Take(game, &snapshots[1]);
+  for (int i = 0; i < 40; ++i) {
+    Play(game, re);
+  }
+  for (int i = 0; i < 40; ++i) {
+    assert(GameUndo(game));
+  }
+  assert(Matches(game, &snapshots[1]));
+  assert(GameUndo(game));
+  assert(Matches(game, &snapshots[0]));
+  // END TEST GameRedo
+
+  // TEST GameReset clears the history
+  GameReset(game);
+  assert(!GameUndo(game) && !GameRedo(game));
+  // END TEST GameReset clears the history
+
+  GameFree(&game);
+  free(snapshots);
+  random_engine_dtor(re);
+}
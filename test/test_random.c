@@ -0,0 +1,348 @@
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "random.h"
+#include "random_device.h"
+#include "xoshiro256ss.h"
+
+// Engine returning 1, 2, 3... without a fill function
+static uint64_t CounterNext(random_engine_t *engine) {
+  uint64_t *counter = random_engine_data(engine);
+  return ++*counter;
+}
+
+static void CounterDtor(random_engine_t *engine) {
+  free(random_engine_data(engine));
+}
+
+static const struct RandomEngineSpec CounterEngine = {
+    .name = "Counter",
+    .next = CounterNext,
+    .dtor = CounterDtor,
+};
+
+// Draws of a sampler, summarized
+typedef struct Moments {
+  double mean;
+  double variance;
+  double mode; // frequency of the value `mode_value`
+} Moments;
+
+#define MOMENT_DRAWS 100000
+
+static Moments BinomialMoments(random_engine_t *engine, uint64_t n, double p,
+                               uint64_t mode_value) {
+  double sum = 0, squares = 0, modes = 0;
+  for (size_t i = 0; i < MOMENT_DRAWS; ++i) {
+    uint64_t x = binomial_distribution(engine, n, p);
+    assert(x <= n);
+    sum += x;
+    squares += (double)x * x;
+    modes += x == mode_value;
+  }
+  double mean = sum / MOMENT_DRAWS;
+  return (Moments){mean, squares / MOMENT_DRAWS - mean * mean,
+                   modes / MOMENT_DRAWS};
+}
+
+static Moments PoissonMoments(random_engine_t *engine, double lambda,
+                              uint64_t mode_value) {
+  double sum = 0, squares = 0, modes = 0;
+  for (size_t i = 0; i < MOMENT_DRAWS; ++i) {
+    uint64_t x = poisson_distribution(engine, lambda);
+    sum += x;
+    squares += (double)x * x;
+    modes += x == mode_value;
+  }
+  double mean = sum / MOMENT_DRAWS;
+  return (Moments){mean, squares / MOMENT_DRAWS - mean * mean,
+                   modes / MOMENT_DRAWS};
+}
+
+static bool Near(double actual, double expected, double tolerance) {
+  return fabs(actual - expected) <= tolerance;
+}
+
+int main(void) {
+  // TEST random_engine_fill
+  random_engine_t *a = Xoshiro256ssEngine.ctor_seed(42);
+  random_engine_t *b = Xoshiro256ssEngine.ctor_seed(42);
+  uint64_t filled[100];
+  random_engine_fill(a, filled, 100);
+  for (size_t i = 0; i < 100; ++i) {
+    assert(filled[i] == random_engine_next(b));
+  }
+  random_engine_fill(a, filled, 0);
+  assert(random_engine_next(a) == random_engine_next(b));
+  random_engine_dtor(a);
+  random_engine_dtor(b);
+  // END TEST random_engine_fill
+
+  // TEST random_engine_fill without a fill function
+  random_engine_t *counter =
+      random_engine_ctor(&CounterEngine, calloc(1, sizeof(uint64_t)));
+  random_engine_fill(counter, filled, 10);
+  for (size_t i = 0; i < 10; ++i) {
+    assert(filled[i] == i + 1);
+  }
+  assert(random_engine_next(counter) == 11);
+  random_engine_dtor(counter);
+  // END TEST random_engine_fill without a fill function
+
+  // TEST random_engine_fill with a random device
+  random_engine_t *device = RandomDeviceEngine.ctor();
+  assert(device);
+  uint64_t bits = 0;
+  random_engine_fill(device, filled, 100);
+  for (size_t i = 0; i < 100; ++i) {
+    bits |= filled[i];
+  }
+  assert(bits != 0);
+  // Larger than a single getrandom(2) call gives, the tail is filled as well
+  size_t large = (33u << 20) / sizeof(uint64_t);
+  uint64_t *big = calloc(large, sizeof(uint64_t));
+  assert(big);
+  random_engine_fill(device, big, large);
+  bits = 0;
+  for (size_t i = large - 16; i < large; ++i) {
+    bits |= big[i];
+  }
+  assert(bits != 0);
+  free(big);
+  random_engine_dtor(device);
+  // END TEST random_engine_fill with a random device
+
+  // TEST splitmix64_next
+  uint64_t splitmix = 0;
+  assert(splitmix64_next(&splitmix) == 0xE220A8397B1DCDAFULL);
+  assert(splitmix == 0x9E3779B97F4A7C15ULL);
+  // Close seeds give unrelated states
+  a = Xoshiro256ssEngine.ctor_seed(1);
+  b = Xoshiro256ssEngine.ctor_seed(2);
+  assert(random_engine_next(a) != random_engine_next(b));
+  random_engine_dtor(a);
+  random_engine_dtor(b);
+  // END TEST splitmix64_next
+
+  // TEST bounded_int_distribution
+  uint64_t lo;
+  assert(random_mul128(UINT64_MAX, UINT64_MAX, &lo) == UINT64_MAX - 1);
+  assert(lo == 1);
+  assert(random_mul128((uint64_t)1 << 32, (uint64_t)3 << 32, &lo) == 3);
+  assert(lo == 0);
+  a = Xoshiro256ssEngine.ctor_seed(3);
+  assert(bounded_int_distribution(a, 1) == 0);
+  // Every value of a small range comes up about as often
+  uint32_t counts[6] = {0};
+  for (size_t i = 0; i < 60000; ++i) {
+    uint64_t value = bounded_int_distribution(a, 6);
+    assert(value < 6);
+    ++counts[value];
+  }
+  for (size_t i = 0; i < 6; ++i) {
+    assert(counts[i] > 9500 && counts[i] < 10500);
+  }
+  // With a range of 3 * 2^62, a modulo would return values below 2^63 three
+  // times out of four instead of two times out of three
+  uint64_t range = (uint64_t)3 << 62, low = 0;
+  for (size_t i = 0; i < 10000; ++i) {
+    uint64_t value = bounded_int_distribution(a, range);
+    assert(value < range);
+    low += value < (uint64_t)1 << 63;
+  }
+  assert(low > 6450 && low < 6900);
+  random_engine_dtor(a);
+  // END TEST bounded_int_distribution
+
+  // TEST bernoulli_threshold_distribution
+  assert(bernoulli_threshold(0.0) == 0);
+  assert(bernoulli_threshold(-1.0) == 0);
+  assert(bernoulli_threshold(0.5) == (uint64_t)1 << 63);
+  assert(bernoulli_threshold(1.0) == UINT64_MAX);
+  a = Xoshiro256ssEngine.ctor_seed(4);
+  uint64_t threshold = bernoulli_threshold(0.9), successes = 0;
+  for (size_t i = 0; i < 10000; ++i) {
+    assert(!bernoulli_threshold_distribution(a, 0));
+    successes += bernoulli_threshold_distribution(a, threshold);
+  }
+  assert(successes > 8800 && successes < 9200);
+  random_engine_dtor(a);
+  // END TEST bernoulli_threshold_distribution
+
+  // TEST xoshiro256ss_t
+  // A seeded state draws the numbers of an engine constructed with its seed
+  xoshiro256ss_t rng;
+  xoshiro256ss_seed(&rng, 42);
+  a = Xoshiro256ssEngine.ctor_seed(42);
+  for (size_t i = 0; i < 100; ++i) {
+    assert(xoshiro256ss_step(&rng) == random_engine_next(a));
+  }
+  for (int max = 0; max < 100; ++max) {
+    assert(xoshiro256ss_uniform_int(&rng, -3, max) ==
+           uniform_int_distribution(a, -3, max));
+    assert(xoshiro256ss_bernoulli(&rng, max / 100.0) ==
+           bernoulli_distribution(a, max / 100.0));
+  }
+  for (uint64_t range = 1; range < 100; ++range) {
+    uint64_t huge = UINT64_MAX / range;
+    assert(xoshiro256ss_bounded(&rng, range) ==
+           bounded_int_distribution(a, range));
+    assert(xoshiro256ss_bounded(&rng, huge) == bounded_int_distribution(a, huge));
+    uint64_t threshold = bernoulli_threshold(range / 100.0);
+    assert(xoshiro256ss_bernoulli_threshold(&rng, threshold) ==
+           bernoulli_threshold_distribution(a, threshold));
+  }
+  random_engine_dtor(a);
+  random_device_t *rd = random_device_ctor();
+  assert(xoshiro256ss_seed_rd(&rng, rd));
+  random_device_dtor(rd);
+  assert(rng.state[0] | rng.state[1] | rng.state[2] | rng.state[3]);
+  // END TEST xoshiro256ss_t
+
+  // TEST jump and long_jump
+  // Jumps are polynomials of the transition, so they commute with `next`
+  a = Xoshiro256ssEngine.ctor_seed(7);
+  b = Xoshiro256ssEngine.ctor_seed(7);
+  Xoshiro256ssEngine.jump(a);
+  random_engine_next(a);
+  random_engine_next(b);
+  Xoshiro256ssEngine.jump(b);
+  for (size_t i = 0; i < 16; ++i) {
+    assert(random_engine_next(a) == random_engine_next(b));
+  }
+  Xoshiro256ssEngine.long_jump(a);
+  assert(random_engine_next(a) != random_engine_next(b));
+  Xoshiro256ssEngine.long_jump(b);
+  for (size_t i = 0; i < 16; ++i) {
+    assert(random_engine_next(a) == random_engine_next(b));
+  }
+  random_engine_dtor(a);
+  random_engine_dtor(b);
+  // END TEST jump and long_jump
+
+  // TEST fork
+  random_engine_t *parent = Xoshiro256ssEngine.ctor_seed(11);
+  random_engine_t *reference = Xoshiro256ssEngine.ctor_seed(11);
+  random_engine_t *children[3];
+  assert(Xoshiro256ssEngine.fork(parent, children, 3));
+  for (size_t c = 0; c < 3; ++c) {
+    // Child `c` draws the stream of the parent after `c` jumps
+    random_engine_t *copy;
+    assert(Xoshiro256ssEngine.fork(reference, &copy, 1));
+    for (size_t i = 0; i < 16; ++i) {
+      assert(random_engine_next(children[c]) == random_engine_next(copy));
+    }
+    random_engine_dtor(copy);
+    random_engine_dtor(children[c]);
+  }
+  // The parent is left past the streams of its children
+  for (size_t i = 0; i < 16; ++i) {
+    assert(random_engine_next(parent) == random_engine_next(reference));
+  }
+  random_engine_dtor(parent);
+  random_engine_dtor(reference);
+  // END TEST fork
+
+  // TEST buffered random device engine
+  // Blocks of 3 numbers, so that draws and fills cross the block boundaries
+  random_engine_t *buffered = random_device_buffered_engine_ctor_size(24);
+  assert(buffered);
+  assert(random_engine_get_spec(buffered) == &RandomDeviceBufferedEngine);
+  uint64_t drawn[8];
+  for (size_t i = 0; i < 8; ++i) {
+    drawn[i] = random_engine_next(buffered);
+    for (size_t j = 0; j < i; ++j) {
+      assert(drawn[i] != drawn[j]);
+    }
+  }
+  for (size_t n = 1; n <= 100; n += 33) {
+    random_engine_fill(buffered, filled, n);
+    for (size_t i = 1; i < n; ++i) {
+      assert(filled[i] != filled[i - 1]);
+    }
+  }
+  random_engine_dtor(buffered);
+
+  // Blocks smaller than a number still hold one
+  buffered = random_device_buffered_engine_ctor_size(3);
+  assert(random_engine_next(buffered) != random_engine_next(buffered));
+  random_engine_dtor(buffered);
+  buffered = RandomDeviceBufferedEngine.ctor();
+  random_engine_fill(buffered, filled, 100);
+  assert(random_engine_next(buffered) != filled[99]);
+  random_engine_dtor(buffered);
+  // END TEST buffered random device engine
+
+  // TEST binomial_distribution
+  a = Xoshiro256ssEngine.ctor_seed(5);
+  assert(binomial_distribution(a, 0, 0.5) == 0);
+  assert(binomial_distribution(a, 10, 0.0) == 0);
+  assert(binomial_distribution(a, 10, 1.0) == 10);
+  // Sequential search, P(X = 6) = 0.191639
+  Moments m = BinomialMoments(a, 20, 0.3, 6);
+  assert(Near(m.mean, 6, 0.05) && Near(m.variance, 4.2, 0.15));
+  assert(Near(m.mode, 0.191639, 0.005));
+  // BTPE, P(X = 50) = 0.0795892
+  m = BinomialMoments(a, 100, 0.5, 50);
+  assert(Near(m.mean, 50, 0.1) && Near(m.variance, 25, 0.75));
+  assert(Near(m.mode, 0.0795892, 0.004));
+  // BTPE on the rarer outcome, P(X = 700000) = 0.00087056
+  m = BinomialMoments(a, 1000000, 0.7, 700000);
+  assert(Near(m.mean, 700000, 3) && Near(m.variance, 210000, 6300));
+  assert(Near(m.mode, 0.00087058, 0.0005));
+  random_engine_dtor(a);
+  // END TEST binomial_distribution
+
+  // TEST poisson_distribution
+  a = Xoshiro256ssEngine.ctor_seed(6);
+  // Multiplication method, P(X = 3) = 0.224042
+  m = PoissonMoments(a, 3.0, 3);
+  assert(Near(m.mean, 3, 0.03) && Near(m.variance, 3, 0.1));
+  assert(Near(m.mode, 0.224042, 0.005));
+  // PTRS, P(X = 100) = 0.0398610
+  m = PoissonMoments(a, 100.0, 100);
+  assert(Near(m.mean, 100, 0.2) && Near(m.variance, 100, 3));
+  assert(Near(m.mode, 0.0398610, 0.003));
+  // exp(-lambda) underflows here, PTRS does not depend on it
+  m = PoissonMoments(a, 1e6, 1000000);
+  assert(Near(m.mean, 1e6, 20) && Near(m.variance, 1e6, 30000));
+  random_engine_dtor(a);
+  // END TEST poisson_distribution
+
+  // TEST alias_table
+  const double weights[] = {1, 0, 2, 0, 5, 0.5, 1.5};
+  const size_t n_weights = sizeof(weights) / sizeof(weights[0]);
+  const double invalid[] = {1, -1};
+  const double zeros[] = {0, 0};
+  const double not_a_number[] = {1, NAN};
+  assert(!alias_table_ctor(weights, 0));
+  assert(!alias_table_ctor(invalid, 2));
+  assert(!alias_table_ctor(zeros, 2));
+  assert(!alias_table_ctor(not_a_number, 2));
+  alias_table_t *table = alias_table_ctor(weights, n_weights);
+  assert(table);
+  assert(alias_table_size(table) == n_weights);
+  a = Xoshiro256ssEngine.ctor_seed(7);
+  uint32_t samples[7] = {0};
+  for (size_t i = 0; i < MOMENT_DRAWS; ++i) {
+    size_t index = alias_table_sample(table, a);
+    assert(index < n_weights);
+    ++samples[index];
+  }
+  for (size_t i = 0; i < n_weights; ++i) {
+    if (weights[i] == 0) {
+      assert(samples[i] == 0);
+    }
+    assert(Near(samples[i] / (double)MOMENT_DRAWS, weights[i] / 10.0, 0.005));
+  }
+  alias_table_dtor(table);
+  // A single weight is always sampled
+  table = alias_table_ctor(weights, 1);
+  assert(alias_table_sample(table, a) == 0);
+  alias_table_dtor(table);
+  random_engine_dtor(a);
+  // END TEST alias_table
+}
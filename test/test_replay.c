@@ -0,0 +1,150 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/game.h"
+#include "core/replay.h"
+
+#define MOVES 6000
+
+// Read back everything written to a stream
+static uint8_t *Contents(FILE *stream, size_t *size) {
+  *size = ftell(stream);
+  uint8_t *data = malloc(*size);
+  rewind(stream);
+  assert(fread(data, 1, *size, stream) == *size);
+  return data;
+}
+
+static bool SameState(Game a, Game b) {
+  return a->score == b->score && a->moves == b->moves &&
+         memcmp(&a->rng, &b->rng, sizeof(a->rng)) == 0 &&
+         a->grid->length == b->grid->length &&
+         memcmp(a->grid->cells, b->grid->cells,
+                a->grid->length * sizeof(uint64_t)) == 0;
+}
+
+int main(void) {
+  random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+
+  // TEST ReplayRecorderInit
+  // Games drawing from another engine cannot be replayed
+  Game engined;
+  GameInitWithEngine(&engined, 4, re);
+  FILE *stream = tmpfile();
+  assert(!GameRecordReplay(engined, stream));
+  assert(engined->recorder == NULL);
+  GameFree(&engined);
+  fclose(stream);
+  // END TEST ReplayRecorderInit
+
+  // TEST ReplayPlayerSeek
+  // A long game on a large grid, with a spawn after every move
+  Game game;
+  GameInitWithSeed(&game, 16, 5);
+  stream = tmpfile();
+  assert(GameRecordReplay(game, stream));
+  uint64_t *scores = malloc((MOVES + 1) * sizeof(uint64_t));
+  uint64_t *cells = malloc((MOVES + 1) * 256 * sizeof(uint64_t));
+  scores[0] = game->score;
+  memcpy(cells, game->grid->cells, 256 * sizeof(uint64_t));
+  for (uint32_t m = 1; m <= MOVES; ++m) {
+    while (!GameMove(game, bounded_int_distribution(re, 4), NULL)) {
+    }
+    GameAddRandomTile(game);
+    ++game->moves;
+    scores[m] = game->score;
+    memcpy(cells + m * 256, game->grid->cells, 256 * sizeof(uint64_t));
+  }
+  assert(GameStopReplay(game));
+  assert(game->recorder == NULL);
+  size_t size;
+  uint8_t *data = Contents(stream, &size);
+  // 2 bits a move, a keyframe and a few record headers
+  assert(size < MOVES / 4 + 2 * 300 + 64);
+
+  ReplayPlayer player;
+  assert(ReplayPlayerInit(&player, data, size));
+  assert(player->n_moves == MOVES && player->n_seeks == 2);
+  assert(ReplayPlayerRun(player));
+  assert(player->played == MOVES);
+  assert(SameState(player->game, game));
+  const uint64_t targets[] = {0, 1, 4095, 4096, 4097, 10, 5999, 6000, 3};
+  for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); ++t) {
+    uint64_t move = targets[t];
+    assert(ReplayPlayerSeek(player, move));
+    assert(player->played == move && player->game->moves == move);
+    assert(player->game->score == scores[move]);
+    assert(memcmp(player->game->grid->cells, cells + move * 256,
+                  256 * sizeof(uint64_t)) == 0);
+  }
+  assert(!ReplayPlayerSeek(player, MOVES + 1));
+  ReplayPlayerFree(&player);
+  assert(player == NULL);
+
+  // A move changed before the keyframe is caught by it
+  size_t header = sizeof(REPLAY_MAGIC) - 1 + 3 +
+                  strlen(Xoshiro256ssEngine.name) + 2 + 32 + 256;
+  data[header + 2] ^= 0x03;
+  assert(ReplayPlayerInit(&player, data, size));
+  assert(!ReplayPlayerRun(player));
+  assert(player->failed && player->played < REPLAY_KEYFRAME_INTERVAL + 1);
+  ReplayPlayerFree(&player);
+  data[header + 2] ^= 0x03;
+
+  // Malformed replays are rejected
+  assert(!ReplayPlayerInit(&player, data, header - 1));
+  assert(!ReplayPlayerInit(&player, data, size - 1));
+  data[0] = 'X';
+  assert(!ReplayPlayerInit(&player, data, size));
+  assert(player == NULL);
+  free(data);
+  free(cells);
+  free(scores);
+  fclose(stream);
+  GameFree(&game);
+  // END TEST ReplayPlayerSeek
+
+  // TEST ReplayPlayerRun
+  // Small games with resets, undos, redos, lone spawns and moves without
+  // spawn play back to the same state
+  GameInitWithSeed(&game, 4, 9);
+  assert(GameRecordHistory(game, 64));
+  stream = tmpfile();
+  assert(GameRecordReplay(game, stream));
+  for (int m = 0; m < MOVES; ++m) {
+    uint64_t action = bounded_int_distribution(re, 100);
+    if (!GridAnyCellAvailable(game->grid) && !GameTileMatchesAvailable(game)) {
+      GameReset(game);
+    } else if (action < 5) {
+      GameUndo(game);
+    } else if (action < 8) {
+      GameRedo(game);
+    } else if (action < 10) {
+      GameAddRandomTile(game);
+    } else if (GameMove(game, bounded_int_distribution(re, 4), NULL)) {
+      if (action >= 12) {
+        GameAddRandomTile(game);
+      }
+      ++game->moves;
+    }
+  }
+  assert(GameStopReplay(game));
+  data = Contents(stream, &size);
+  assert(ReplayPlayerInit(&player, data, size));
+  assert(ReplayPlayerRun(player));
+  assert(SameState(player->game, game));
+  ReplayPlayerFree(&player);
+  rewind(stream);
+  assert(ReplayPlayerLoad(&player, stream));
+  assert(player->size == size);
+  ReplayPlayerFree(&player);
+  free(data);
+  fclose(stream);
+  GameFree(&game);
+  // END TEST ReplayPlayerRun
+
+  random_engine_dtor(re);
+}
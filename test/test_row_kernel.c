@@ -0,0 +1,92 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "core/row_kernel.h"
+#include "random.h"
+
+static const RowKernel *KERNELS[] = {&RowKernelScalar, &RowKernelSse41,
+                                     &RowKernelAvx2, &RowKernelNeon};
+
+#define KERNEL_COUNT (sizeof(KERNELS) / sizeof(KERNELS[0]))
+
+int main(void) {
+  // TEST RowKernelGet
+  const RowKernel *best = RowKernelGet();
+  assert(best);
+  assert(best->supported());
+  assert(RowKernelGet() == best);
+  assert(RowKernelScalar.supported());
+  // END TEST RowKernelGet
+
+  for (size_t k = 0; k < KERNEL_COUNT; ++k) {
+    const RowKernel *kernel = KERNELS[k];
+    if (!kernel->supported()) {
+      continue;
+    }
+
+    // TEST move64
+    uint64_t row[8] = {2, 2, 2, 2, 0, 4, 0, 4};
+    const uint64_t expectedRow[8] = {4, 4, 8, 0, 0, 0, 0, 0};
+    uint64_t score = 0;
+    assert(kernel->move64(row, 8, &score));
+    assert(memcmp(row, expectedRow, sizeof(row)) == 0);
+    assert(score == 16);
+    assert(!kernel->move64(row + 3, 5, &score));
+    uint64_t packed[5] = {8, 4, 8, 2, 0};
+    assert(!kernel->move64(packed, 5, &score));
+    assert(score == 16);
+    // END TEST move64
+
+    // TEST move8
+    uint8_t exponents[8] = {1, 1, 1, 1, 0, 2, 0, 2};
+    const uint8_t expectedExponents[8] = {2, 2, 3, 0, 0, 0, 0, 0};
+    score = 0;
+    assert(kernel->move8(exponents, 8, &score));
+    assert(memcmp(exponents, expectedExponents, sizeof(exponents)) == 0);
+    assert(score == 16);
+    uint8_t largest[3] = {0, UINT8_MAX, UINT8_MAX};
+    assert(kernel->move8(largest, 3, &score));
+    assert(largest[0] == UINT8_MAX && largest[1] == UINT8_MAX);
+    assert(!kernel->move8(largest, 3, &score));
+    // END TEST move8
+
+    // TEST random rows against the scalar kernel
+    random_engine_t *re = Xoshiro256ssEngine.ctor_seed(2048);
+    for (uint16_t length = 1; length <= UINT8_MAX; ++length) {
+      for (int round = 0; round < 8; ++round) {
+        uint64_t values[UINT8_MAX], expectedValues[UINT8_MAX];
+        uint8_t small[UINT8_MAX], expectedSmall[UINT8_MAX];
+        // Few distinct exponents and a varying density, to get long runs of
+        // empty cells and of equal tiles
+        uint8_t empty = round * 2;
+        for (uint16_t i = 0; i < length; ++i) {
+          uint64_t draw = random_engine_next(re);
+          small[i] = draw % 16 < empty ? 0 : 1 + (draw >> 8) % 3;
+          if (draw % 61 == 0) {
+            small[i] = UINT8_MAX;
+          }
+          values[i] = small[i] ? (uint64_t)1 << (small[i] % 16) : 0;
+        }
+        memcpy(expectedValues, values, sizeof(values));
+        memcpy(expectedSmall, small, sizeof(small));
+        uint64_t expectedScore = 0, actualScore = 0;
+        bool expectedMoved =
+            RowKernelScalar.move64(expectedValues, length, &expectedScore);
+        assert(kernel->move64(values, length, &actualScore) == expectedMoved);
+        assert(memcmp(values, expectedValues, length * sizeof(uint64_t)) == 0);
+        assert(actualScore == expectedScore);
+
+        expectedScore = actualScore = 0;
+        expectedMoved =
+            RowKernelScalar.move8(expectedSmall, length, &expectedScore);
+        assert(kernel->move8(small, length, &actualScore) == expectedMoved);
+        assert(memcmp(small, expectedSmall, length) == 0);
+        assert(actualScore == expectedScore);
+      }
+    }
+    random_engine_dtor(re);
+    // END TEST random rows against the scalar kernel
+  }
+}
@@ -0,0 +1,154 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "core/bitboard.h"
+#include "core/grid.h"
+#include "core/transposition.h"
+
+#define RACE_THREADS 4
+#define RACE_KEYS 64
+#define RACE_ROUNDS 200000
+
+typedef struct RaceWorker {
+  pthread_t thread;
+  TranspositionTable table;
+  uint64_t seed;
+  uint64_t hits; ///< Probes that found an entry
+  uint64_t torn; ///< Hits whose entry belongs to another position
+} RaceWorker;
+
+// Position `i` of the race, spread over the whole hash
+static uint64_t RaceKey(uint64_t i) {
+  return (i + 1) * 0x9E3779B97F4A7C15ULL;
+}
+
+// Every position has its own entry, so a hit can be checked against its hash
+static TranspositionEntry RaceEntry(uint64_t hash) {
+  return (TranspositionEntry){
+      .value = (float)(uint16_t)(hash >> 16),
+      .depth = (hash >> 8) & 0x3F,
+      .move = hash & 0x3,
+  };
+}
+
+// Store and probe random positions of a few shared buckets
+static void *RaceRun(void *argument) {
+  RaceWorker *worker = argument;
+  uint64_t state = worker->seed;
+  for (uint32_t round = 0; round < RACE_ROUNDS; ++round) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    uint64_t hash = RaceKey(state % RACE_KEYS);
+    if (state & (1 << 20)) {
+      TranspositionEntry entry = RaceEntry(hash);
+      TranspositionStore(worker->table, hash, &entry);
+    } else {
+      TranspositionEntry found, expected = RaceEntry(hash);
+      if (TranspositionProbe(worker->table, hash, 0, &found)) {
+        ++worker->hits;
+        worker->torn += found.value != expected.value ||
+                        found.depth != expected.depth ||
+                        found.move != expected.move;
+      }
+    }
+  }
+  return NULL;
+}
+
+int main(void) {
+  TranspositionTable table, race;
+  // TEST INITIALIZATION
+  TranspositionInit(&table, 8);
+  assert(table);
+  assert(table->mask == 255);
+  TranspositionStats stats = TranspositionGetStats(table);
+  assert(stats.probes == 0 && stats.hits == 0 && stats.stores == 0);
+  // END TEST INITIALIZATION
+
+  // TEST hashing
+  Grid grid;
+  GridInit(&grid, 4);
+  assert(TranspositionHashGrid(grid) == 0);
+  uint64_t gridCells[16] = {2, 0, 0, 2, 0, 2, 2, 0, 0, 0, 0, 32768, 0, 0, 0, 4};
+  memcpy(grid->cells, gridCells, 16 * sizeof(uint64_t));
+  Bitboard board;
+  assert(BitboardFromGrid(grid, &board));
+  uint64_t hash = TranspositionHashGrid(grid);
+  assert(hash != 0);
+  assert(hash == TranspositionHashBitboard(board));
+  grid->cells[0] = 0;
+  grid->cells[1] = 2;
+  assert(TranspositionHashGrid(grid) != hash);
+  GridFree(&grid);
+  // END TEST hashing
+
+  // TEST store and probe
+  TranspositionEntry entry = {.value = 1.5f, .depth = 3, .move = RIGHT};
+  TranspositionEntry found;
+  assert(!TranspositionProbe(table, hash, 0, &found));
+  TranspositionStore(table, hash, &entry);
+  assert(TranspositionProbe(table, hash, 3, &found));
+  assert(found.value == 1.5f);
+  assert(found.depth == 3);
+  assert(found.move == RIGHT);
+  assert(!TranspositionProbe(table, hash, 4, &found));
+  stats = TranspositionGetStats(table);
+  assert(stats.probes == 3);
+  assert(stats.hits == 1);
+  assert(stats.stores == 1);
+  // END TEST store and probe
+
+  // TEST replacement
+  // Fill the bucket of `hash` with deeper entries of other positions
+  TranspositionNewSearch(table);
+  for (uint64_t i = 1; i <= TRANSPOSITION_BUCKET_SIZE; ++i) {
+    TranspositionEntry deep = {.value = 0, .depth = 10, .move = LEFT};
+    TranspositionStore(table, hash + (i << 32), &deep);
+  }
+  assert(!TranspositionProbe(table, hash, 0, &found)); // older entry evicted
+  stats = TranspositionGetStats(table);
+  assert(stats.overwrites == 1);
+  // END TEST replacement
+
+  // TEST clear
+  TranspositionClear(table);
+  assert(!TranspositionProbe(table, hash + (1ULL << 32), 0, &found));
+  stats = TranspositionGetStats(table);
+  assert(stats.probes == 1 && stats.hits == 0 && stats.stores == 0);
+  // END TEST clear
+
+  // TEST concurrent store and probe
+  // 4 buckets shared by every thread, a probe racing with a store of another
+  // position in the same slot must read as a miss
+  TranspositionInit(&race, 4);
+  RaceWorker workers[RACE_THREADS] = {0};
+  for (int i = 0; i < RACE_THREADS; ++i) {
+    workers[i].table = race;
+    workers[i].seed = RaceKey(1000 + i);
+    int rc = pthread_create(&workers[i].thread, NULL, RaceRun, &workers[i]);
+    assert(rc == 0);
+    (void)rc;
+  }
+  uint64_t hits = 0;
+  for (int i = 0; i < RACE_THREADS; ++i) {
+    int rc = pthread_join(workers[i].thread, NULL);
+    assert(rc == 0);
+    (void)rc;
+    assert(workers[i].torn == 0);
+    hits += workers[i].hits;
+  }
+  assert(hits > 0);
+  stats = TranspositionGetStats(race);
+  assert(stats.hits == hits);
+  TranspositionFree(&race);
+  // END TEST concurrent store and probe
+
+  // TEST Free
+  TranspositionFree(&table);
+  assert(table == NULL);
+  // END TEST Free
+}
@@ -0,0 +1,114 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "random.h"
+#include "xoshiro256ss.h"
+#include "xoshiro256ss_lanes.h"
+
+static const xoshiro256ss_lanes_kernel_t *KERNELS[] = {
+    &Xoshiro256ssLanesScalar, &Xoshiro256ssLanesAvx2, &Xoshiro256ssLanesAvx512};
+
+#define KERNEL_COUNT (sizeof(KERNELS) / sizeof(KERNELS[0]))
+#define STEPS 100
+
+static uint64_t out[STEPS * XOSHIRO256SS_LANES];
+
+int main(void) {
+  // TEST xoshiro256ss_lanes_kernel
+  const xoshiro256ss_lanes_kernel_t *best = xoshiro256ss_lanes_kernel();
+  assert(best);
+  assert(best->supported());
+  assert(xoshiro256ss_lanes_kernel() == best);
+  assert(Xoshiro256ssLanesScalar.supported());
+  // END TEST xoshiro256ss_lanes_kernel
+
+  // TEST xoshiro256ss_lanes_seed
+  // Lane `l` is the fork child `l` of an engine with the same seed
+  xoshiro256ss_lanes_t lanes;
+  xoshiro256ss_lanes_seed(&lanes, 2048);
+  random_engine_t *parent = Xoshiro256ssEngine.ctor_seed(2048);
+  random_engine_t *children[XOSHIRO256SS_LANES];
+  assert(Xoshiro256ssEngine.fork(parent, children, XOSHIRO256SS_LANES));
+  for (size_t l = 0; l < XOSHIRO256SS_LANES; ++l) {
+    xoshiro256ss_t rng;
+    xoshiro256ss_lanes_get(&lanes, l, &rng);
+    for (size_t i = 0; i < 16; ++i) {
+      assert(xoshiro256ss_step(&rng) == random_engine_next(children[l]));
+    }
+    random_engine_dtor(children[l]);
+  }
+  random_engine_dtor(parent);
+  // END TEST xoshiro256ss_lanes_seed
+
+  for (size_t k = 0; k < KERNEL_COUNT; ++k) {
+    const xoshiro256ss_lanes_kernel_t *kernel = KERNELS[k];
+    if (!kernel->supported()) {
+      continue;
+    }
+
+    // TEST fill matches scalar xoshiro256ss_next per lane
+    xoshiro256ss_lanes_seed(&lanes, 42);
+    random_engine_t *engines[XOSHIRO256SS_LANES];
+    for (size_t l = 0; l < XOSHIRO256SS_LANES; ++l) {
+      xoshiro256ss_t rng;
+      xoshiro256ss_lanes_get(&lanes, l, &rng);
+      engines[l] = Xoshiro256ssEngine.ctor_full(rng.state);
+    }
+    // Uneven batches, the state must carry over between calls
+    kernel->fill(&lanes, out, 1);
+    kernel->fill(&lanes, out + XOSHIRO256SS_LANES, 0);
+    kernel->fill(&lanes, out + XOSHIRO256SS_LANES, STEPS - 1);
+    for (size_t s = 0; s < STEPS; ++s) {
+      for (size_t l = 0; l < XOSHIRO256SS_LANES; ++l) {
+        assert(out[s * XOSHIRO256SS_LANES + l] == xoshiro256ss_next(engines[l]));
+      }
+    }
+    for (size_t l = 0; l < XOSHIRO256SS_LANES; ++l) {
+      random_engine_dtor(engines[l]);
+    }
+    // END TEST fill matches scalar xoshiro256ss_next per lane
+
+    // TEST set and get single lanes
+    xoshiro256ss_t rng, lane3;
+    xoshiro256ss_seed(&rng, 7);
+    xoshiro256ss_lanes_set(&lanes, 3, &rng);
+    kernel->fill(&lanes, out, 2);
+    xoshiro256ss_lanes_get(&lanes, 3, &lane3);
+    assert(out[3] == xoshiro256ss_step(&rng));
+    assert(out[XOSHIRO256SS_LANES + 3] == xoshiro256ss_step(&rng));
+    assert(memcmp(&lane3, &rng, sizeof(rng)) == 0);
+    // END TEST set and get single lanes
+  }
+
+  // TEST Xoshiro256ssLanesEngine
+  // next and fill serve the lanes in the order of xoshiro256ss_lanes_fill
+  xoshiro256ss_lanes_seed(&lanes, 9);
+  xoshiro256ss_lanes_fill(&lanes, out, STEPS);
+  random_engine_t *a = xoshiro256ss_lanes_engine_ctor_seed(9);
+  random_engine_t *b = xoshiro256ss_lanes_engine_ctor_seed(9);
+  assert(random_engine_get_spec(a) ==
+         (random_engine_spec_t)&Xoshiro256ssLanesEngine);
+  uint64_t filled[STEPS * XOSHIRO256SS_LANES];
+  size_t position = 0;
+  const size_t batches[] = {3, 5, 0, 16, 1, 200, 7};
+  for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i) {
+    random_engine_fill(a, filled + position, batches[i]);
+    position += batches[i];
+    filled[position] = random_engine_next(a);
+    ++position;
+  }
+  for (size_t i = 0; i < position; ++i) {
+    assert(filled[i] == out[i]);
+    assert(random_engine_next(b) == out[i]);
+  }
+  random_engine_dtor(a);
+  random_engine_dtor(b);
+  a = Xoshiro256ssLanesEngine.ctor();
+  assert(a);
+  random_engine_fill(a, filled, 64);
+  assert(filled[0] != filled[XOSHIRO256SS_LANES]);
+  random_engine_dtor(a);
+  // END TEST Xoshiro256ssLanesEngine
+}